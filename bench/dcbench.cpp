@@ -0,0 +1,843 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include "analyzerequest.h"
+#include "analyzeservice.h"
+#include "beholdhelper.h"
+#include "featuresearch.h"
+#include "httpserver.h"
+#include "imagedecode.h"
+#include "jsonwriter.h"
+#include "networkhelper.h"
+#include "responseencoding.h"
+#include "screenclassifier.h"
+#include "templatematcher.h"
+#include "utils.h"
+#include "voyimage.h"
+
+#include "json.hpp"
+#include "args.h"
+
+// Micro-benchmarks of the analysis hot paths. Every benchmark reports the median, fastest and mean time per call, plus a
+// "result" computed by the code under test (keypoints found, match score, number read...) so a diff between two commits shows
+// behaviour changes next to the timings. The report is JSON with sorted keys and benchmarks in a fixed order.
+
+namespace fs = std::filesystem;
+using namespace DataCore;
+
+using Clock = std::chrono::steady_clock;
+
+class Bench
+{
+  public:
+	Bench(double minSeconds, std::string filter) : _minSeconds(minSeconds), _filter(std::move(filter))
+	{
+	}
+
+	bool Enabled(const std::string &name) const
+	{
+		return _filter.empty() || (name.find(_filter) != std::string::npos);
+	}
+
+	// Runs body (returning an int64_t result) in batches long enough for the clock to be accurate, until minSeconds have
+	// passed and there are enough samples
+	template <class F> void Run(const std::string &name, const std::string &fixture, F &&body)
+	{
+		if (!Enabled(name))
+			return;
+
+		std::cerr << name << " " << fixture << std::endl;
+
+		int64_t result = body();
+
+		size_t batch = 1;
+		for (;;) {
+			double ns = Time(body, batch);
+			if ((ns >= MIN_BATCH_NS) || (batch >= (1u << 24)))
+				break;
+			batch *= 2;
+		}
+
+		std::vector<double> samples;
+		double total = 0;
+		while (((total < _minSeconds * 1e9) || (samples.size() < MIN_SAMPLES)) && (samples.size() < MAX_SAMPLES)) {
+			double ns = Time(body, batch);
+			samples.push_back(ns / batch);
+			total += ns;
+		}
+
+		std::sort(samples.begin(), samples.end());
+		double mean = 0;
+		for (double sample : samples)
+			mean += sample;
+		mean /= samples.size();
+
+		_results.push_back({{"name", name},
+							{"fixture", fixture},
+							{"ns",
+							 {{"median", Round(samples[samples.size() / 2])}, {"min", Round(samples.front())}, {"mean", Round(mean)}}},
+							{"result", result}});
+	}
+
+	void Skip(const std::string &name, const std::string &fixture, const std::string &reason)
+	{
+		if (Enabled(name))
+			_results.push_back({{"name", name}, {"fixture", fixture}, {"skipped", reason}});
+	}
+
+	void Add(nlohmann::json result)
+	{
+		_results.push_back(std::move(result));
+	}
+
+	const nlohmann::json &Results() const
+	{
+		return _results;
+	}
+
+	// Three significant digits, so the report doesn't churn on noise below that
+	static double Round(double value)
+	{
+		if (value <= 0)
+			return 0;
+		int exponent = (int)std::floor(std::log10(value)) - 2;
+		if (exponent >= 0) {
+			double magnitude = std::pow(10.0, exponent);
+			return std::round(value / magnitude) * magnitude;
+		}
+		double scale = std::pow(10.0, -exponent);
+		return std::round(value * scale) / scale;
+	}
+
+  private:
+	static constexpr double MIN_BATCH_NS = 20000;
+	static constexpr size_t MIN_SAMPLES = 5;
+	static constexpr size_t MAX_SAMPLES = 10000;
+
+	template <class F> double Time(F &body, size_t batch)
+	{
+		auto start = Clock::now();
+		for (size_t i = 0; i < batch; i++)
+			_sink += body();
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+	}
+
+	double _minSeconds;
+	std::string _filter;
+	nlohmann::json _results = nlohmann::json::array();
+	volatile int64_t _sink{0};
+};
+
+static cv::Mat ReadTemplate(const std::string &dataPath, const char *name)
+{
+	return cv::imread(fs::path(dataPath + name).make_preferred().string());
+}
+
+// Pastes tpl resized to the given height at (x, y)
+static void Paste(cv::Mat canvas, cv::Mat tpl, int x, int y, int height)
+{
+	if (tpl.empty())
+		return;
+
+	cv::Mat scaled;
+	cv::resize(tpl, scaled, cv::Size(tpl.cols * height / tpl.rows, height), 0, 0, cv::INTER_AREA);
+	cv::Mat target = canvas(cv::Rect(x, y, scaled.cols, scaled.rows));
+	scaled.copyTo(target);
+}
+
+// A dark background with some seeded clutter, so SURF finds about as many keypoints as on a real screen
+static cv::Mat Background(cv::Size size, uint64_t seed)
+{
+	cv::Mat canvas(size, CV_8UC3, cv::Scalar(24, 16, 12));
+	cv::RNG rng(seed);
+	for (int i = 0; i < 400; i++) {
+		cv::Point a(rng.uniform(0, size.width), rng.uniform(0, size.height));
+		cv::Point b(a.x + rng.uniform(4, 80), a.y + rng.uniform(4, 80));
+		cv::rectangle(canvas, a, b, cv::Scalar(rng.uniform(0, 90), rng.uniform(0, 90), rng.uniform(0, 90)), cv::FILLED);
+	}
+	return canvas;
+}
+
+static void Text(cv::Mat canvas, const std::string &text, cv::Point baseline, int height)
+{
+	double scale = cv::getFontScaleFromHeight(cv::FONT_HERSHEY_SIMPLEX, height, 3);
+	cv::putText(canvas, text, baseline, cv::FONT_HERSHEY_SIMPLEX, scale, cv::Scalar(255, 255, 255), 3, cv::LINE_AA);
+}
+
+// The behold dialog, laid out where AnalyzeBehold looks: the title centered in the top strip, three crew portraits with their
+// rows of stars and a close button in the upper right corner. The portraits are clutter, not crew, so they won't match the
+// trained set; the work done to find that out is the same.
+static cv::Mat SyntheticBehold(const std::string &dataPath, cv::Size size, uint64_t seed = 1)
+{
+	cv::Mat canvas = Background(size, seed);
+	float unit = (float)size.width / 100;
+
+	Paste(canvas, ReadTemplate(dataPath, "behold_title.png"), size.width / 2 - 160, 4, std::min(size.height / 13, 80) - 8);
+	Paste(canvas, ReadTemplate(dataPath, "closebutton.png"), size.width - (int)(unit * 4), (int)unit, (int)(unit * 3));
+
+	cv::Mat star = ReadTemplate(dataPath, "starfull.png");
+	for (int crew = 0; crew < 3; crew++) {
+		int left = size.width * crew / 3 + 30;
+		for (int i = 0; i < 3 + crew; i++)
+			Paste(canvas, star, left + (int)(i * unit * 3), (int)(unit * 9.6), (int)(unit * 2));
+	}
+
+	return canvas;
+}
+
+struct VoyageFixture
+{
+	cv::Mat image;
+	cv::Rect antimatter; // where the antimatter number was drawn
+	cv::Rect skill;		 // where the command skill value was drawn
+	int iconHeight{0};
+};
+
+// The voyage setup screen: the antimatter icon and amount in the top strip, the six skill icons with their values in the bottom
+// one, in the arrangement AnalyzeVoyImage expects
+static VoyageFixture SyntheticVoyage(const std::string &dataPath, cv::Size size, uint64_t seed = 2)
+{
+	VoyageFixture fixture;
+	fixture.image = Background(size, seed);
+	cv::Mat canvas = fixture.image;
+
+	int iconHeight = size.height / 22;
+	fixture.iconHeight = iconHeight;
+
+	int amX = size.width * 5 / 12;
+	int amY = size.height / 20;
+	Paste(canvas, ReadTemplate(dataPath, "antimatter.png"), amX, amY, iconHeight);
+	fixture.antimatter = cv::Rect(amX + iconHeight, amY, iconHeight * 3, iconHeight);
+	Text(canvas, "2840", cv::Point(fixture.antimatter.x + iconHeight / 4, amY + iconHeight * 4 / 5), iconHeight * 3 / 5);
+
+	const char *left[] = {"cmd.png", "dip.png", "eng.png"};
+	const char *right[] = {"sec.png", "med.png", "sci.png"};
+	const char *values[] = {"1125", "987", "1342", "876", "1003", "1210"};
+	int top = size.height - size.height / 5;
+	int leftX = size.width * 9 / 20;
+	int rightX = size.width * 11 / 20;
+	for (int row = 0; row < 3; row++) {
+		int y = top + row * (iconHeight + iconHeight / 4);
+		Paste(canvas, ReadTemplate(dataPath, left[row]), leftX, y, iconHeight);
+		Paste(canvas, ReadTemplate(dataPath, right[row]), rightX, y, iconHeight);
+		Text(canvas, values[row], cv::Point(leftX - iconHeight * 4, y + iconHeight * 4 / 5), iconHeight * 3 / 5);
+		Text(canvas, values[row + 3], cv::Point(rightX + iconHeight * 3 / 2, y + iconHeight * 4 / 5), iconHeight * 3 / 5);
+	}
+	fixture.skill = cv::Rect(leftX - iconHeight * 5, top, iconHeight * 5, iconHeight);
+
+	return fixture;
+}
+
+// Some other dialog: a close button and a heading where the behold title would be, for the classifier to leave alone
+static cv::Mat SyntheticDialog(const std::string &dataPath, cv::Size size, uint64_t seed)
+{
+	cv::Mat canvas = Background(size, seed);
+	float unit = (float)size.width / 100;
+	int titleHeight = std::min(size.height / 13, 80);
+
+	Paste(canvas, ReadTemplate(dataPath, "closebutton.png"), size.width - (int)(unit * 4), (int)unit, (int)(unit * 3));
+	Text(canvas, "CREW DETAILS", cv::Point(size.width / 2 - 200, titleHeight - 15), titleHeight / 2);
+
+	return canvas;
+}
+
+static std::string SizeName(cv::Size size)
+{
+	return std::to_string(size.width) + "x" + std::to_string(size.height);
+}
+
+struct Screenshot
+{
+	std::string name;
+	PreparedImage image;
+};
+
+// The crops AnalyzeBehold describes: the top strip with the title, and the first crew portrait
+static std::vector<std::pair<std::string, cv::Rect>> BeholdCrops(cv::Size size)
+{
+	return {{"top", SubRect(0, std::min(size.height / 13, 80), size.width / 3, size.width * 2 / 3)},
+			{"crew", SubRect(size.height * 2 / 8, (int)(size.height * 4.5 / 8), 30, size.width / 3)}};
+}
+
+static void BenchFeatures(Bench &bench, const std::vector<Screenshot> &screenshots, const std::string &dataPath,
+						  const std::string &trainPath)
+{
+	Descriptor descriptor;
+
+	cv::Mat title = ReadTemplate(dataPath, "behold_title.png");
+	if (!title.empty()) {
+		bench.Run("surf.detectAndCompute", "data/behold_title.png", [&]() -> int64_t { return descriptor.Describe(title).rows; });
+	} else {
+		bench.Skip("surf.detectAndCompute", "data/behold_title.png", "not found");
+	}
+
+	for (const auto &screenshot : screenshots) {
+		for (const auto &crop : BeholdCrops(screenshot.image.bgr.size())) {
+			std::string fixture = screenshot.name + "/" + crop.first + " " + SizeName(crop.second.size());
+			cv::Mat gray = screenshot.image.gray(crop.second);
+			bench.Run("surf.detectAndCompute", fixture, [&]() -> int64_t { return descriptor.Describe(gray).rows; });
+
+			if (!screenshot.image.integral.empty()) {
+				cv::Rect integralCrop(crop.second.x, crop.second.y, crop.second.width + 1, crop.second.height + 1);
+				cv::Mat integral = screenshot.image.integral(integralCrop);
+				bench.Run("surf.detectAndComputeWithIntegral", fixture,
+						  [&]() -> int64_t { return descriptor.Describe(gray, integral).rows; });
+			}
+		}
+	}
+
+	if (!bench.Enabled("searcher.match"))
+		return;
+
+	// The trained set as ReInitialize leaves it: the title from data/ plus every symbol trained so far
+	Searcher searcher;
+	if (!title.empty())
+		searcher.Add(descriptor.Describe(title(cv::Rect(0, 0, title.cols, title.rows * 7 / 10))), "behold_title");
+
+	std::vector<fs::path> trained;
+	if (fs::is_directory(trainPath)) {
+		for (const auto &entry : fs::directory_iterator(trainPath)) {
+			if (entry.is_regular_file() && (entry.path().extension() == ".bin") && (entry.path().stem() != "behold_title"))
+				trained.push_back(entry.path());
+		}
+	}
+	std::sort(trained.begin(), trained.end());
+
+	std::vector<std::string> symbols;
+	for (const auto &path : trained) {
+		cv::Mat features = matread(path.string());
+		if (!features.empty()) {
+			symbols.push_back(path.stem().string());
+			searcher.Add(features, symbols.back().c_str());
+		}
+	}
+
+	std::string setName = std::to_string(symbols.size() + 1) + " symbols";
+	for (const auto &screenshot : screenshots) {
+		for (const auto &crop : BeholdCrops(screenshot.image.bgr.size())) {
+			std::string fixture = screenshot.name + "/" + crop.first + " " + SizeName(crop.second.size()) + ", " + setName;
+			bench.Run("searcher.match", fixture, [&]() -> int64_t { return searcher.Match(screenshot.image, crop.second).score; });
+		}
+	}
+}
+
+static void BenchTemplates(Bench &bench, const std::string &dataPath, cv::Size size)
+{
+	std::string name = "synthetic-behold-" + SizeName(size);
+	cv::Mat behold = SyntheticBehold(dataPath, size);
+
+	TemplateMatcher starFull;
+	starFull.Reset(ReadTemplate(dataPath, "starfull.png"));
+	TemplateMatcher closeButton;
+	closeButton.Reset(ReadTemplate(dataPath, "closebutton.png"));
+
+	if (!starFull.empty()) {
+		// The star strip of the last crew, brought to the height AnalyzeBehold uses
+		float scale = (float)size.width / 100;
+		cv::Mat stars = SubMat(behold, (int)(scale * 9.2), (int)(scale * 12.8), size.width * 2 / 3 + 30, size.width - 30);
+		cv::resize(stars, stars, cv::Size(stars.cols * 72 / stars.rows, 72), 0, 0, cv::INTER_AREA);
+
+		bench.Run("behold.countFullStars", name + "/stars " + SizeName(stars.size()),
+				  [&]() -> int64_t { return CountFullStars(stars, starFull); });
+	}
+
+	if (!closeButton.empty()) {
+		int side = (int)(std::min(size.width, size.height) * 0.11);
+		cv::Mat corner = SubMat(behold, 0, side, size.width - side, size.width);
+		cv::resize(corner, corner, cv::Size(78, 78), 0, 0, cv::INTER_AREA);
+
+		bench.Run("behold.countFullStars", name + "/close button corner",
+				  [&]() -> int64_t { return CountFullStars(corner, closeButton, 0.7); });
+	}
+
+	name = "synthetic-voyage-" + SizeName(size);
+	VoyageFixture voyage = SyntheticVoyage(dataPath, size);
+
+	cv::Mat cmd = ReadTemplate(dataPath, "cmd.png");
+	if (!cmd.empty()) {
+		// The bottom strip as AnalyzeVoyImage thresholds it, against the command icon at the height it was drawn with
+		cv::Mat bottom;
+		cv::threshold(SubMat(voyage.image, size.height * 3 / 4, size.height, size.width / 6, size.width * 5 / 6), bottom, 100, 1,
+					  cv::THRESH_TOZERO);
+		cv::Mat scaled;
+		cv::resize(cmd, scaled, cv::Size(cmd.cols * voyage.iconHeight / cmd.rows, voyage.iconHeight), 0, 0, cv::INTER_AREA);
+		std::string fixture = name + "/bottom " + SizeName(bottom.size()) + ", cmd " + SizeName(scaled.size());
+
+		bench.Run("voyimage.scaleInvariantTemplateMatch", fixture, [&]() -> int64_t {
+			cv::Point maxloc;
+			return std::lround(ScaleInvariantTemplateMatch(bottom, scaled, &maxloc) * 1000);
+		});
+
+		TemplateMatcher matcher;
+		matcher.Reset(cmd);
+		bench.Run("templatematcher.matchMax", fixture, [&]() -> int64_t {
+			MatchTarget target(bottom);
+			cv::Point maxloc;
+			return std::lround(matcher.MatchMax(target, &maxloc, voyage.iconHeight) * 1000);
+		});
+	}
+}
+
+static void BenchOCR(Bench &bench, const std::string &dataPath, cv::Size size)
+{
+	if (!bench.Enabled("voyimage.ocrNumber"))
+		return;
+
+	std::string name = "synthetic-voyage-" + SizeName(size);
+	std::shared_ptr<IVoyImageScanner> scanner = MakeVoyImageScanner(dataPath);
+	if (!scanner->ReInitialize(false)) {
+		bench.Skip("voyimage.ocrNumber", name, "Tesseract could not be initialized from " + dataPath + "tessdata");
+		return;
+	}
+
+	VoyageFixture voyage = SyntheticVoyage(dataPath, size);
+	for (const auto &crop : {std::make_pair("antimatter", voyage.antimatter), std::make_pair("cmd", voyage.skill)}) {
+		cv::Mat number;
+		cv::threshold(voyage.image(crop.second), number, 100, 1, cv::THRESH_TOZERO);
+		bench.Run("voyimage.ocrNumber", name + "/" + crop.first + " " + SizeName(number.size()),
+				  [&]() -> int64_t { return scanner->OCRNumber(number); });
+	}
+}
+
+// Classify on every screenshot, then how often it's right: synthetic behold, voyage, other dialog and clutter only screens at
+// several sizes and backgrounds, the bare templates from data/, and the --images screenshots whose names start with "behold" or
+// "voyage". Unknown only costs the time of the analyzer that wasn't needed; any other wrong type loses a result.
+static void BenchClassifier(Bench &bench, const std::vector<Screenshot> &screenshots, const std::string &dataPath)
+{
+	std::shared_ptr<IScreenClassifier> classifier = MakeScreenClassifier(dataPath);
+	if (!classifier->ReInitialize()) {
+		bench.Skip("classifier.classify", dataPath, "templates not found");
+		bench.Skip("classifier.accuracy", dataPath, "templates not found");
+		return;
+	}
+
+	for (const auto &screenshot : screenshots)
+		bench.Run("classifier.classify", screenshot.name,
+				  [&]() -> int64_t { return (int64_t)classifier->Classify(screenshot.image).type; });
+
+	const char *NAME = "classifier.accuracy";
+	if (!bench.Enabled(NAME))
+		return;
+
+	std::cerr << NAME << std::endl;
+
+	size_t screens = 0;
+	size_t unknown = 0;
+	size_t misclassified = 0;
+	nlohmann::json errors = nlohmann::json::array();
+
+	// Per expected type, the lowest score of the matching probe and the highest of any other
+	const ScreenType TYPES[] = {ScreenType::Unknown, ScreenType::Behold, ScreenType::Voyage};
+	double matchingMin[3] = {1, 1, 1};
+	double otherMax[3] = {0, 0, 0};
+
+	// Screenshots are prepared one at a time, there are a couple hundred
+	auto check = [&](const std::string &name, ScreenType expected, const PreparedImage &image) {
+		if (image.empty())
+			return;
+
+		ScreenClassification classification = classifier->Classify(image);
+		screens++;
+
+		int index = (int)expected;
+		double matching = (expected == ScreenType::Behold) ? classification.beholdScore : classification.voyageScore;
+		double other = (expected == ScreenType::Behold) ? classification.voyageScore : classification.beholdScore;
+		if (expected == ScreenType::Unknown)
+			other = std::max(classification.beholdScore, classification.voyageScore);
+		else
+			matchingMin[index] = std::min(matchingMin[index], matching);
+		otherMax[index] = std::max(otherMax[index], other);
+
+		if (classification.type == expected)
+			return;
+
+		if (classification.type == ScreenType::Unknown)
+			unknown++;
+		else
+			misclassified++;
+		errors.push_back({{"fixture", name},
+						  {"expected", ToString(expected)},
+						  {"classified", ToString(classification.type)},
+						  {"beholdScore", Bench::Round(classification.beholdScore)},
+						  {"voyageScore", Bench::Round(classification.voyageScore)}});
+	};
+
+	const cv::Size SIZES[] = {cv::Size(1280, 720), cv::Size(1920, 1080), cv::Size(2340, 1080), cv::Size(2560, 1440),
+							  cv::Size(2048, 1536)};
+	for (uint64_t seed = 1; seed <= 10; seed++) {
+		for (cv::Size size : SIZES) {
+			std::string suffix = "-" + SizeName(size) + "/" + std::to_string(seed);
+			check("synthetic-behold" + suffix, ScreenType::Behold, PrepareImage(SyntheticBehold(dataPath, size, seed), 0, 1080));
+			check("synthetic-voyage" + suffix, ScreenType::Voyage, PrepareImage(SyntheticVoyage(dataPath, size, seed).image, 0, 1080));
+			check("synthetic-dialog" + suffix, ScreenType::Unknown, PrepareImage(SyntheticDialog(dataPath, size, seed), 0, 1080));
+			check("synthetic-clutter" + suffix, ScreenType::Unknown, PrepareImage(Background(size, seed), 0, 1080));
+		}
+	}
+
+	std::vector<fs::path> templates;
+	for (const auto &entry : fs::directory_iterator(dataPath)) {
+		if (entry.is_regular_file() && (entry.path().extension() == ".png"))
+			templates.push_back(entry.path());
+	}
+	std::sort(templates.begin(), templates.end());
+	for (const auto &path : templates)
+		check("data/" + path.filename().string(), ScreenType::Unknown, PrepareImage(cv::imread(path.string()), 0, 1080));
+
+	for (const auto &screenshot : screenshots) {
+		if (screenshot.name.compare(0, 6, "behold") == 0)
+			check(screenshot.name, ScreenType::Behold, screenshot.image);
+		else if (screenshot.name.compare(0, 6, "voyage") == 0)
+			check(screenshot.name, ScreenType::Voyage, screenshot.image);
+	}
+
+	nlohmann::json scores = nlohmann::json::object();
+	for (ScreenType type : TYPES) {
+		int index = (int)type;
+		nlohmann::json &entry = scores[ToString(type)];
+		if (type != ScreenType::Unknown)
+			entry["matchingMin"] = Bench::Round(matchingMin[index]);
+		entry["otherMax"] = Bench::Round(otherMax[index]);
+	}
+
+	bench.Add({{"name", NAME},
+			   {"fixture", std::to_string(screens) + " screens"},
+			   {"screens", screens},
+			   {"unknown", unknown},
+			   {"misclassified", misclassified},
+			   {"scores", scores},
+			   {"errors", errors}});
+}
+
+// Whole /api/behold requests with and without the classifier, for its effect on durationMs. Needs what the server runs with: a
+// --jsonpath holding crew.json and ship_schematics.json, and a --trainpath with those symbols trained already.
+static void BenchAnalyze(Bench &bench, const std::vector<Screenshot> &screenshots, const std::string &dataPath,
+						 const std::string &trainPath, const std::string &jsonPath)
+{
+	const char *NAME = "analyze.both";
+	if (!bench.Enabled(NAME))
+		return;
+
+	if (jsonPath.empty()) {
+		bench.Skip(NAME, "", "no --jsonpath to train the behold analyzer from");
+		return;
+	}
+
+	std::shared_ptr<IBeholdHelper> beholdHelper = MakeBeholdHelper(trainPath, dataPath);
+	std::shared_ptr<IVoyImageScanner> voyImageScanner = MakeVoyImageScanner(dataPath);
+	std::shared_ptr<IScreenClassifier> screenClassifier = MakeScreenClassifier(dataPath);
+
+	bool initialized = false;
+	try {
+		// Symbols missing from trainPath get downloaded from here
+		initialized = beholdHelper->ReInitialize(false, jsonPath, "https://assets.datacore.app/") &&
+					  voyImageScanner->ReInitialize(false) && screenClassifier->ReInitialize();
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+	}
+	if (!initialized) {
+		bench.Skip(NAME, jsonPath, "analyzers could not be initialized");
+		return;
+	}
+
+	AnalyzeServiceConfig config;
+	config.jsonpath = jsonPath;
+	std::shared_ptr<IAnalyzeService> service = MakeAnalyzeService(beholdHelper, voyImageScanner, screenClassifier, config);
+
+	for (const auto &screenshot : screenshots) {
+		// Sent as raw pixels, so decoding stays out of the timings
+		cv::Mat pixels = screenshot.image.bgr.isContinuous() ? screenshot.image.bgr : screenshot.image.bgr.clone();
+
+		for (bool classify : {false, true}) {
+			AnalyzeRequest request;
+			request.operation = AnalyzeOperation::Both;
+			request.options.classify = classify;
+			request.imageData = pixels.data;
+			request.imageSize = pixels.total() * pixels.elemSize();
+			request.imageWidth = pixels.cols;
+			request.imageHeight = pixels.rows;
+			request.imageChannels = pixels.channels();
+
+			bench.Run(NAME, screenshot.name + (classify ? ", classified" : ", both analyzers"),
+					  [&]() -> int64_t { return (int64_t)service->Analyze(request).screenType; });
+		}
+	}
+}
+
+static void BenchUrls(Bench &bench)
+{
+	const std::pair<const char *, const char *> urls[] = {
+		{"asset", "https://assets.datacore.app/crew_full_body_cm_qjudge_sm_full.png"},
+		{"port and query", "http://user@images.example.com:8080/screens/2020/voyage.png?size=large&v=3#top"},
+		{"discord attachment", "https://cdn.discordapp.com/attachments/700000000000000000/750000000000000000/"
+							   "Screenshot_20200901-201512.png?ex=65a1b2c3&is=65a06143&hm=0123456789abcdef0123456789abcdef"}};
+
+	for (const auto &url : urls) {
+		std::string_view view(url.second);
+		bench.Run("network.parseURI", url.first, [view]() -> int64_t {
+			ParsedURI uri;
+			if (!parseURI(view, &uri))
+				return -1;
+			return (int64_t)(uri.protocol.size() + uri.domain.size() + uri.port.size() + uri.resource.size() + uri.query.size());
+		});
+	}
+
+	const std::pair<const char *, const char *> encoded[] = {
+		{"plain", "https://assets.datacore.app/crew_full_body_cm_qjudge_sm_full.png"},
+		{"encoded discord attachment", "https%3A%2F%2Fcdn.discordapp.com%2Fattachments%2F700000000000000000%2F750000000000000000%2F"
+									   "Screenshot_20200901-201512.png%3Fex%3D65a1b2c3%26is%3D65a06143%26hm%3D0123456789abcdef"}};
+
+	std::string buffer;
+	for (const auto &url : encoded) {
+		std::string_view view(url.second);
+		bench.Run("http.uriDecode", url.first, [view, &buffer]() -> int64_t { return (int64_t)UriDecode(view, buffer).size(); });
+	}
+}
+
+static void BenchJson(Bench &bench)
+{
+	// A full successful reply to /api/behold, every field filled in
+	AnalyzeResponse response;
+	response.operation = AnalyzeOperation::Both;
+	response.success = true;
+	response.url = "https://cdn.discordapp.com/attachments/700000000000000000/750000000000000000/Screenshot_20200901-201512.png";
+	response.durationMs = 182;
+	response.screenType = ScreenType::Behold;
+
+	SearchResults &behold = response.beholdResult;
+	behold.input_width = 2340;
+	behold.input_height = 1080;
+	behold.fileSize = 2483901;
+	behold.top = {"behold_title", 212};
+	behold.crew1 = {"ent_crew_sto_mirror_picard", 87, 4};
+	behold.crew2 = {"kirk_tos_captain_crew", 121, 5};
+	behold.crew3 = {"tlaan_crew", 64, 2};
+
+	VoySearchResults &voyage = response.voyResult;
+	voyage.input_width = 2340;
+	voyage.input_height = 1080;
+	voyage.fileSize = 2483901;
+	voyage.error = "Could not read antimatter";
+
+	std::string out;
+	bench.Run("json.writeJson", "AnalyzeResponse", [&]() -> int64_t {
+		out.clear();
+		WriteJson(out, response);
+		return (int64_t)out.size();
+	});
+	bench.Run("json.writeJson", "SearchResults", [&]() -> int64_t {
+		out.clear();
+		WriteJson(out, behold);
+		return (int64_t)out.size();
+	});
+	bench.Run("json.nlohmann", "AnalyzeResponse", [&]() -> int64_t { return (int64_t)nlohmann::json(response).dump().size(); });
+
+	const std::pair<const char *, ResponseEncoding> encodings[] = {{"msgpack", ResponseEncoding::MsgPack},
+																	{"cbor", ResponseEncoding::Cbor}};
+	for (const auto &encoding : encodings) {
+		bench.Run(std::string("json.") + encoding.first, "AnalyzeResponse", [&]() -> int64_t {
+			out.clear();
+			EncodeResponse(out, response, encoding.second);
+			return (int64_t)out.size();
+		});
+	}
+}
+
+// New connections per second against the HTTP server with one listener and with several SO_REUSEPORT ones. Every client thread
+// connects, asks for /api/metrics (answered without touching the analyzers) and reads until the server closes.
+static void BenchConnections(Bench &bench, unsigned short port, double seconds)
+{
+	const char *NAME = "http.connections";
+	if (!bench.Enabled(NAME))
+		return;
+
+	AnalyzeHandler handler = [](const AnalyzeRequest &request) -> AnalyzeResponse {
+		AnalyzeResponse response;
+		response.operation = request.operation;
+		response.success = true;
+		response.metrics = nlohmann::json::object();
+		return response;
+	};
+
+	size_t cores = std::max(2u, std::thread::hardware_concurrency());
+	size_t clients = cores * 2;
+
+	for (size_t acceptors : {(size_t)1, cores}) {
+		std::string fixture = "acceptors=" + std::to_string(acceptors) + ", clients=" + std::to_string(clients);
+		std::cerr << NAME << " " << fixture << std::endl;
+
+		// The server runs until the process exits
+		HttpServerOptions options;
+		options.acceptors = acceptors;
+		std::thread([handler, port, options]() { start_http_server(handler, "127.0.0.1", port, options); }).detach();
+
+		boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"), port);
+		bool listening = false;
+		for (int attempt = 0; (attempt < 100) && !listening; attempt++) {
+			boost::asio::io_context ioc;
+			boost::asio::ip::tcp::socket socket(ioc);
+			boost::system::error_code ec;
+			socket.connect(endpoint, ec);
+			listening = !ec;
+			if (!listening)
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+		if (!listening) {
+			bench.Skip(NAME, fixture, "server did not start on port " + std::to_string(port));
+			port++;
+			continue;
+		}
+
+		static const std::string REQUEST = "GET /api/metrics HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+
+		std::atomic<size_t> connections{0};
+		std::atomic<size_t> failures{0};
+		std::atomic<bool> stop{false};
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < clients; i++) {
+			threads.emplace_back([&]() {
+				boost::asio::io_context ioc;
+				std::string reply;
+				while (!stop) {
+					boost::system::error_code ec;
+					boost::asio::ip::tcp::socket socket(ioc);
+					socket.connect(endpoint, ec);
+					if (!ec)
+						boost::asio::write(socket, boost::asio::buffer(REQUEST), ec);
+					if (!ec) {
+						reply.clear();
+						boost::asio::read(socket, boost::asio::dynamic_buffer(reply), ec);
+					}
+
+					if ((ec == boost::asio::error::eof) && (reply.compare(0, 12, "HTTP/1.1 200") == 0))
+						connections++;
+					else
+						failures++;
+				}
+			});
+		}
+
+		auto start = Clock::now();
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+		stop = true;
+		for (auto &thread : threads)
+			thread.join();
+		double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+		bench.Add({{"name", NAME},
+				   {"fixture", fixture},
+				   {"connections", connections.load()},
+				   {"failures", failures.load()},
+				   {"perSecond", Bench::Round(connections / elapsed)}});
+
+		port++;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	args::ArgumentParser parser("DataCore image analysis micro-benchmarks");
+	args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+	args::ValueFlag<std::string> dataPath(parser, "datapath", "Pathname for folder where input data is stored", {'d', "datapath"},
+										  "../data/");
+	args::ValueFlag<std::string> trainPath(parser, "trainpath", "Pathname for folder where train data is stored", {'t', "trainpath"},
+										   "../train/");
+	args::ValueFlag<std::string> jsonPath(parser, "jsonpath", "Website folder with crew.json, to also benchmark whole requests",
+										  {'j', "jsonpath"});
+	args::ValueFlag<std::string> images(parser, "images", "Also benchmark on the .png and .jpg screenshots in this folder",
+										{'i', "images"});
+	args::ValueFlag<std::string> output(parser, "out", "Write the JSON report to this file instead of stdout", {'o', "out"});
+	args::ValueFlag<std::string> filter(parser, "filter", "Only run benchmarks whose name contains this", {'f', "filter"});
+	args::ValueFlag<double> minTime(parser, "mintime", "Seconds spent on each benchmark at least", {"mintime"}, 0.5);
+	args::ValueFlag<int> port(parser, "port", "First local port for the HTTP connection benchmark", {"port"}, 5100);
+	args::ValueFlag<double> connectionTime(parser, "connectiontime", "Seconds each HTTP connection benchmark runs", {"connectiontime"}, 2);
+
+	try {
+		parser.ParseCLI(argc, argv);
+	} catch (const args::Help &) {
+		std::cout << parser;
+		return 0;
+	} catch (const args::ParseError &e) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return 1;
+	}
+
+	// The report may go to stdout, where the code under test logs; that goes to stderr then
+	std::ostream reportStdout(std::cout.rdbuf());
+	if (!output)
+		std::cout.rdbuf(std::cerr.rdbuf());
+
+	const std::string data = args::get(dataPath);
+	const cv::Size SIZES[] = {cv::Size(1280, 720), cv::Size(1920, 1080)};
+
+	std::vector<Screenshot> screenshots;
+	for (cv::Size size : SIZES)
+		screenshots.push_back({"synthetic-behold-" + SizeName(size), PrepareImage(SyntheticBehold(data, size), 0, 1080)});
+
+	// Only the classifier and whole requests look at a voyage screen as a whole
+	std::vector<Screenshot> screens = screenshots;
+	for (cv::Size size : SIZES)
+		screens.push_back({"synthetic-voyage-" + SizeName(size), PrepareImage(SyntheticVoyage(data, size).image, 0, 1080)});
+
+	if (images) {
+		std::vector<fs::path> files;
+		for (const auto &entry : fs::directory_iterator(args::get(images))) {
+			std::string extension = entry.path().extension().string();
+			if (entry.is_regular_file() && ((extension == ".png") || (extension == ".jpg") || (extension == ".jpeg")))
+				files.push_back(entry.path());
+		}
+		std::sort(files.begin(), files.end());
+
+		for (const auto &file : files) {
+			PreparedImage image = PrepareImage(cv::imread(file.string()), (size_t)fs::file_size(file), 1080);
+			if (!image.empty()) {
+				screenshots.push_back({file.filename().string(), image});
+				screens.push_back({file.filename().string(), std::move(image)});
+			}
+		}
+	}
+
+	Bench bench(args::get(minTime), args::get(filter));
+
+	BenchFeatures(bench, screenshots, data, args::get(trainPath));
+	for (cv::Size size : SIZES)
+		BenchTemplates(bench, data, size);
+	BenchOCR(bench, data, SIZES[1]);
+	BenchClassifier(bench, screens, data);
+	BenchAnalyze(bench, screens, data, args::get(trainPath), args::get(jsonPath));
+	BenchUrls(bench);
+	BenchJson(bench);
+	BenchConnections(bench, (unsigned short)args::get(port), args::get(connectionTime));
+
+	nlohmann::json report = {{"benchmarks", bench.Results()}, {"hardwareThreads", std::thread::hardware_concurrency()}};
+
+	std::ofstream outputFile;
+	if (output) {
+		outputFile.open(args::get(output), std::ios::binary | std::ios::trunc);
+		if (!outputFile) {
+			std::cerr << "Can't write " << args::get(output) << std::endl;
+			return 1;
+		}
+	}
+	std::ostream &out = output ? outputFile : reportStdout;
+	out << report.dump(2) << std::endl;
+	out.flush();
+
+	// The HTTP servers never return; don't wait on them
+	std::quick_exit(0);
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+
+#include "admission.h"
+#include "metrics.h"
+#include "threadpool.h"
+
+namespace DataCore {
+
+AdmissionController::Ticket::Ticket(AdmissionController *owner, double cost) : _owner(owner), _cost(cost)
+{
+}
+
+AdmissionController::Ticket::~Ticket()
+{
+	_owner->Release(_cost, _running, std::chrono::steady_clock::now() - _started);
+}
+
+void AdmissionController::Ticket::Start()
+{
+	_started = std::chrono::steady_clock::now();
+	_running = true;
+}
+
+AdmissionController::AdmissionController(double maxQueuedCost) : _maxQueuedCost(maxQueuedCost)
+{
+}
+
+double AdmissionController::EstimateCost(const AnalyzeRequest &request)
+{
+	switch (request.operation) {
+	case AnalyzeOperation::Behold:
+		return 1;
+	case AnalyzeOperation::VoyImage:
+		return 1.5;
+	case AnalyzeOperation::Both:
+		// The classifier usually narrows this down to one analyzer, but not always
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+std::shared_ptr<AdmissionController::Ticket> AdmissionController::TryAdmit(double cost, int *retryAfterSeconds, TaskPriority priority)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	double budget = (priority == TaskPriority::Backfill) ? _maxQueuedCost * BACKFILL_SHARE : _maxQueuedCost;
+
+	// Free requests always get in, and so does anything when nothing else is queued
+	if ((cost > 0) && (_queuedCost > 0) && (_queuedCost + cost > budget)) {
+		// About how long until the pool has worked through what is queued now
+		double waitMs = _queuedCost * _msPerCost / std::max<size_t>(ThreadPool::Shared().Size(), 1);
+		*retryAfterSeconds = std::clamp((int)std::ceil(waitMs / 1000), 1, 60);
+
+		Metrics::Instance().Increment("admission.rejected");
+		return nullptr;
+	}
+
+	_queuedCost += cost;
+	Metrics::Instance().Increment("admission.accepted");
+
+	// Not make_shared, the constructor is private
+	return std::shared_ptr<Ticket>(new Ticket(this, cost));
+}
+
+double AdmissionController::QueuedCost()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _queuedCost;
+}
+
+void AdmissionController::Release(double cost, bool ran, std::chrono::steady_clock::duration elapsed)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_queuedCost = std::max(_queuedCost - cost, 0.0);
+
+	if (ran && (cost > 0)) {
+		double ms = std::chrono::duration<double, std::milli>(elapsed).count() / cost;
+		_msPerCost = _msPerCost * 0.9 + ms * 0.1;
+	}
+}
+
+} // namespace DataCore
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#include "analyzerequest.h"
+
+namespace DataCore {
+
+// Bounds the work the servers take on. Every admitted request holds its estimated cost until it finishes; a request that would
+// push the total over the budget is turned away up front (HTTP 503 with Retry-After) instead of queueing behind work that will
+// outlive its deadline anyway.
+class AdmissionController
+{
+  public:
+	// Held while an admitted request is queued or running, gives its cost back when destroyed
+	class Ticket
+	{
+	  public:
+		~Ticket();
+
+		// Marks the moment a worker picked the request up, so only the running time feeds the Retry-After estimate
+		void Start();
+
+	  private:
+		friend class AdmissionController;
+		Ticket(AdmissionController *owner, double cost);
+
+		AdmissionController *_owner;
+		double _cost;
+		std::chrono::steady_clock::time_point _started;
+		bool _running{false};
+	};
+
+	// maxQueuedCost is in EstimateCost units, roughly one behold analysis each
+	explicit AdmissionController(double maxQueuedCost);
+
+	// Relative cost of a request: voyage OCR is the most expensive, metrics and reinit are free
+	static double EstimateCost(const AnalyzeRequest &request);
+
+	// A ticket if the request fits in the budget, nullptr (and a suggested wait) if it doesn't. Backfill only gets
+	// BACKFILL_SHARE of the budget, so a bulk job can't fill the queue and lock out interactive requests.
+	std::shared_ptr<Ticket> TryAdmit(double cost, int *retryAfterSeconds, TaskPriority priority = TaskPriority::Interactive);
+
+	static constexpr double BACKFILL_SHARE = 0.5;
+
+	double QueuedCost();
+
+  private:
+	void Release(double cost, bool ran, std::chrono::steady_clock::duration elapsed);
+
+	double _maxQueuedCost;
+	double _queuedCost{0};
+
+	// Running estimate of wall time per cost unit, used for Retry-After
+	double _msPerCost{500};
+
+	std::mutex _mutex;
+};
+
+} // namespace DataCore
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "beholdhelper.h"
+#include "json.hpp"
+#include "requestcontext.h"
+#include "screenclassifier.h"
+#include "threadpool.h"
+#include "voyimage.h"
+
+namespace DataCore {
+
+enum class AnalyzeOperation
+{
+	Behold,
+	VoyImage,
+	Both,
+	Metrics,
+	ReInit,
+	ForceReInit
+};
+
+// The command names of the string protocol
+inline const char *ToString(AnalyzeOperation operation)
+{
+	switch (operation) {
+	case AnalyzeOperation::Behold:
+		return "BEHOLD";
+	case AnalyzeOperation::VoyImage:
+		return "VOYIMAGE";
+	case AnalyzeOperation::Both:
+		return "BOTH";
+	case AnalyzeOperation::Metrics:
+		return "METRICS";
+	case AnalyzeOperation::ReInit:
+		return "REINIT";
+	case AnalyzeOperation::ForceReInit:
+		return "FORCEREINIT";
+	}
+
+	return "UNKNOWN";
+}
+
+// "interactive" or "backfill", as sent in the X-Priority header or an envelope's "priority" field
+inline bool ParsePriority(std::string_view name, TaskPriority *priority)
+{
+	if (name == "interactive") {
+		*priority = TaskPriority::Interactive;
+		return true;
+	} else if (name == "backfill") {
+		*priority = TaskPriority::Backfill;
+		return true;
+	}
+
+	return false;
+}
+
+// Per request overrides, unset values fall back to the command line defaults
+struct AnalyzeOptions
+{
+	std::optional<bool> classify;
+};
+
+// A parsed request as handed to the analyzers. url and image are only views: they point into the transport's buffers and are
+// valid for the duration of the call.
+struct AnalyzeRequest
+{
+	AnalyzeOperation operation{AnalyzeOperation::Both};
+	std::string_view url;
+	AnalyzeOptions options;
+
+	// The encoded screenshot when the client sent it inline; the url is not downloaded then
+	const uint8_t *imageData{nullptr};
+	size_t imageSize{0};
+
+	// Set when imageData holds raw 8-bit pixels (gray, BGR or BGRA, rows packed) rather than an encoded image
+	int imageWidth{0};
+	int imageHeight{0};
+	int imageChannels{0};
+
+	// Which worker pool queue the request waits in
+	TaskPriority priority{TaskPriority::Interactive};
+
+	// Set by the transport; cancelled when the client goes away or the deadline passes
+	std::shared_ptr<RequestContext> context;
+};
+
+// Wall time spent in each stage of an analysis, in milliseconds; stages that didn't run stay 0
+struct AnalyzeTimings
+{
+	double prepareMs{0}; // download (unless inline) and decode
+	double classifyMs{0};
+	double voyageMs{0};
+	double beholdMs{0};
+};
+
+// What the analyzers produced for an AnalyzeRequest. Which fields are meaningful depends on the operation, see to_json.
+struct AnalyzeResponse
+{
+	AnalyzeOperation operation{AnalyzeOperation::Both};
+	bool success{false};
+	std::string error; // why success is false, if there's more to say
+	std::string url;
+	SearchResults beholdResult{};
+	VoySearchResults voyResult{};
+	ScreenType screenType{ScreenType::Unknown};
+	int64_t durationMs{0};
+	nlohmann::json metrics;
+	AnalyzeTimings timings; // not part of the JSON replies
+};
+
+// Same shapes the string protocol has always replied with
+inline void to_json(nlohmann::json &j, const AnalyzeResponse &r)
+{
+	j = nlohmann::json::object();
+	if (!r.success) {
+		if (!r.error.empty())
+			j["error"] = r.error;
+		j["success"] = false;
+		return;
+	}
+
+	switch (r.operation) {
+	case AnalyzeOperation::Metrics:
+		j["metrics"] = r.metrics;
+		break;
+	case AnalyzeOperation::Behold:
+		j["beholdUrl"] = r.url;
+		j["results"] = r.beholdResult;
+		break;
+	case AnalyzeOperation::VoyImage:
+		j["voyImageUrl"] = r.url;
+		j["results"] = r.voyResult;
+		break;
+	case AnalyzeOperation::Both:
+		j["url"] = r.url;
+		j["beholdResult"] = r.beholdResult;
+		j["voyResult"] = r.voyResult;
+		j["screenType"] = ToString(r.screenType);
+		j["durationMs"] = r.durationMs;
+		break;
+	default:
+		break;
+	}
+
+	j["success"] = true;
+}
+
+using AnalyzeHandler = std::function<AnalyzeResponse(const AnalyzeRequest &)>;
+
+} // namespace DataCore
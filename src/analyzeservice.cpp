@@ -0,0 +1,383 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "analyzeservice.h"
+#include "imagedecode.h"
+#include "metrics.h"
+#include "networkhelper.h"
+
+namespace DataCore {
+
+class AnalyzeService : public IAnalyzeService
+{
+  public:
+	AnalyzeService(std::shared_ptr<IBeholdHelper> beholdHelper, std::shared_ptr<IVoyImageScanner> voyImageScanner,
+				   std::shared_ptr<IScreenClassifier> screenClassifier, const AnalyzeServiceConfig &config)
+		: _beholdHelper(beholdHelper), _voyImageScanner(voyImageScanner), _screenClassifier(screenClassifier), _config(config)
+	{
+	}
+
+	AnalyzeResponse Analyze(const AnalyzeRequest &request) override;
+
+  private:
+	PreparedImage Prepare(const AnalyzeRequest &request, const std::string &url);
+	void AnalyzeBoth(const AnalyzeRequest &request, AnalyzeResponse *response);
+
+	std::shared_ptr<IBeholdHelper> _beholdHelper;
+	std::shared_ptr<IVoyImageScanner> _voyImageScanner;
+	std::shared_ptr<IScreenClassifier> _screenClassifier;
+	AnalyzeServiceConfig _config;
+	NetworkHelper _networkHelper;
+};
+
+// Milliseconds since the previous Lap, or since construction
+class StageTimer
+{
+  public:
+	double Lap()
+	{
+		auto now = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(now - _last).count();
+		_last = now;
+		return ms;
+	}
+
+  private:
+	std::chrono::steady_clock::time_point _last{std::chrono::steady_clock::now()};
+};
+
+// Download (unless the image came inline) and decode once per request; the analyzers share the result
+PreparedImage AnalyzeService::Prepare(const AnalyzeRequest &request, const std::string &url)
+{
+	if ((request.imageData != nullptr) && (request.imageWidth > 0)) {
+		// Only read from; PrepareImage copies wherever it converts or scales
+		cv::Mat pixels(request.imageHeight, request.imageWidth, CV_8UC(request.imageChannels), const_cast<uint8_t *>(request.imageData));
+		return PrepareImage(pixels, request.imageSize, _config.workingSize);
+	}
+
+	if (request.imageData != nullptr)
+		return PrepareImage(request.imageData, request.imageSize, _config.workingSize);
+
+	PreparedImage image;
+	_networkHelper.downloadUrl(url, [&](std::vector<uint8_t> &&v) -> bool {
+		image = PrepareImage(v.data(), v.size(), _config.workingSize);
+		return true;
+	}, request.context.get());
+
+	return image;
+}
+
+void AnalyzeService::AnalyzeBoth(const AnalyzeRequest &request, AnalyzeResponse *response)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	const RequestContext *context = request.context.get();
+	StageTimer timer;
+	PreparedImage image = Prepare(request, response->url);
+	response->timings.prepareMs = timer.Lap();
+	if (IsCancelled(context))
+		return;
+
+	// Only run the analyzer(s) the screenshot could be for
+	ScreenClassification classification;
+	if (request.options.classify.value_or(_config.classify)) {
+		classification = _screenClassifier->Classify(image);
+		response->timings.classifyMs = timer.Lap();
+	}
+
+	if (classification.type != ScreenType::Behold) {
+		response->voyResult = _voyImageScanner->AnalyzeVoyImage(image, context);
+		response->timings.voyageMs = timer.Lap();
+	} else {
+		response->voyResult.fileSize = image.fileSize;
+		response->voyResult.input_height = image.inputSize.height;
+		response->voyResult.input_width = image.inputSize.width;
+		response->voyResult.error = "Skipped, screenshot looks like a behold";
+	}
+
+	if (IsCancelled(context))
+		return;
+
+	if (classification.type != ScreenType::Voyage) {
+		response->beholdResult = _beholdHelper->AnalyzeBehold(image, context);
+		response->timings.beholdMs = timer.Lap();
+	} else {
+		response->beholdResult.fileSize = image.fileSize;
+		response->beholdResult.input_height = image.inputSize.height;
+		response->beholdResult.input_width = image.inputSize.width;
+		response->beholdResult.error = "Skipped, screenshot looks like a voyage";
+	}
+
+	response->screenType = classification.type;
+	response->durationMs =
+		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+AnalyzeResponse AnalyzeService::Analyze(const AnalyzeRequest &request)
+{
+	std::cout << "Request received: " << ToString(request.operation) << " " << request.url << std::endl;
+
+	AnalyzeResponse response;
+	response.operation = request.operation;
+	response.url = std::string(request.url);
+	response.success = true;
+
+	switch (request.operation) {
+	case AnalyzeOperation::ReInit:
+		// Reinitialize by reloading the asset list from the configured path
+		_beholdHelper->ReInitialize(false, _config.jsonpath, _config.asseturl);
+		break;
+
+	case AnalyzeOperation::ForceReInit:
+		// Force reinitialize by re-downloading and re-parsing all assets
+		_beholdHelper->ReInitialize(true, _config.jsonpath, _config.asseturl);
+		break;
+
+	case AnalyzeOperation::Metrics:
+		// Report the process-wide counters (cache hit rates etc.)
+		response.metrics = Metrics::Instance().Snapshot();
+		break;
+
+	case AnalyzeOperation::Behold: {
+		StageTimer timer;
+		PreparedImage image = Prepare(request, response.url);
+		response.timings.prepareMs = timer.Lap();
+		response.beholdResult = _beholdHelper->AnalyzeBehold(image, request.context.get());
+		response.timings.beholdMs = timer.Lap();
+		break;
+	}
+
+	case AnalyzeOperation::VoyImage: {
+		StageTimer timer;
+		PreparedImage image = Prepare(request, response.url);
+		response.timings.prepareMs = timer.Lap();
+		response.voyResult = _voyImageScanner->AnalyzeVoyImage(image, request.context.get());
+		response.timings.voyageMs = timer.Lap();
+		break;
+	}
+
+	case AnalyzeOperation::Both:
+		AnalyzeBoth(request, &response);
+		break;
+
+	default:
+		response.success = false;
+		break;
+	}
+
+	// Nobody is waiting for partial results
+	if (IsCancelled(request.context.get())) {
+		Metrics::Instance().Increment("request.cancelled");
+		response.success = false;
+		response.error = "Cancelled";
+	}
+
+	return response;
+}
+
+std::shared_ptr<IAnalyzeService> MakeAnalyzeService(std::shared_ptr<IBeholdHelper> beholdHelper,
+													std::shared_ptr<IVoyImageScanner> voyImageScanner,
+													std::shared_ptr<IScreenClassifier> screenClassifier, const AnalyzeServiceConfig &config)
+{
+	return std::make_shared<AnalyzeService>(beholdHelper, voyImageScanner, screenClassifier, config);
+}
+
+bool ParseCommand(std::string_view message, AnalyzeRequest *request)
+{
+	static const AnalyzeOperation OPERATIONS[] = {AnalyzeOperation::ReInit, AnalyzeOperation::ForceReInit, AnalyzeOperation::Metrics,
+												  AnalyzeOperation::Behold, AnalyzeOperation::VoyImage,	   AnalyzeOperation::Both};
+
+	for (AnalyzeOperation operation : OPERATIONS) {
+		std::string_view name = ToString(operation);
+		if (message.compare(0, name.size(), name) == 0) {
+			request->operation = operation;
+			request->url = message.substr(name.size());
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool IsEnvelope(std::string_view message)
+{
+	size_t first = message.find_first_not_of(" \t\r\n");
+	return (first != std::string_view::npos) && (message[first] == '{');
+}
+
+static bool ParseEnvelope(const nlohmann::json &envelope, AnalyzeRequest *request)
+{
+	if (!envelope.is_object())
+		return false;
+
+	auto priority = envelope.find("priority");
+	if ((priority != envelope.end()) && priority->is_string() &&
+		!ParsePriority(priority->get_ref<const std::string &>(), &request->priority))
+		return false;
+
+	auto command = envelope.find("command");
+	if ((command != envelope.end()) && command->is_string())
+		return ParseCommand(command->get_ref<const std::string &>(), request);
+
+	auto operation = envelope.find("operation");
+	if ((operation == envelope.end()) || !operation->is_string())
+		return false;
+
+	// The operation name on its own parses as a command with an empty url
+	AnalyzeRequest parsed;
+	const std::string &name = operation->get_ref<const std::string &>();
+	if (!ParseCommand(name, &parsed) || !parsed.url.empty())
+		return false;
+	request->operation = parsed.operation;
+
+	auto url = envelope.find("url");
+	if ((url != envelope.end()) && url->is_string())
+		request->url = url->get_ref<const std::string &>();
+
+	auto classify = envelope.find("classify");
+	if ((classify != envelope.end()) && classify->is_boolean())
+		request->options.classify = classify->get<bool>();
+
+	// Raw pixels in an image frame
+	auto width = envelope.find("width");
+	auto height = envelope.find("height");
+	auto channels = envelope.find("channels");
+	if ((width != envelope.end()) || (height != envelope.end()) || (channels != envelope.end())) {
+		if ((width == envelope.end()) || !width->is_number_integer() || (height == envelope.end()) || !height->is_number_integer())
+			return false;
+
+		request->imageWidth = width->get<int>();
+		request->imageHeight = height->get<int>();
+		request->imageChannels = ((channels != envelope.end()) && channels->is_number_integer()) ? channels->get<int>() : 3;
+
+		bool validChannels = (request->imageChannels == 1) || (request->imageChannels == 3) || (request->imageChannels == 4);
+		bool validSize = (request->imageWidth > 0) && (request->imageHeight > 0) && (request->imageWidth <= 65535) &&
+						 (request->imageHeight <= 65535);
+		if (!validSize || !validChannels)
+			return false;
+	}
+
+	return true;
+}
+
+static const char IMAGE_FRAME_MAGIC[4] = {'D', 'C', 'I', 'M'};
+static const size_t IMAGE_FRAME_PREFIX = sizeof(IMAGE_FRAME_MAGIC) + sizeof(uint32_t);
+
+// The frame may sit in memory another process can write to (the shared memory transport), so the prefix is read once into a copy
+// and the header is only used through the checked headerSize
+static bool ImageFrameHeaderSize(const uint8_t *data, size_t size, size_t *headerSize)
+{
+	if (size < IMAGE_FRAME_PREFIX)
+		return false;
+
+	uint8_t prefix[IMAGE_FRAME_PREFIX];
+	std::memcpy(prefix, data, IMAGE_FRAME_PREFIX);
+	if (std::memcmp(prefix, IMAGE_FRAME_MAGIC, sizeof(IMAGE_FRAME_MAGIC)) != 0)
+		return false;
+
+	const uint8_t *length = prefix + sizeof(IMAGE_FRAME_MAGIC);
+	*headerSize = (size_t)length[0] | ((size_t)length[1] << 8) | ((size_t)length[2] << 16) | ((size_t)length[3] << 24);
+	return *headerSize <= size - IMAGE_FRAME_PREFIX;
+}
+
+// A copy of the frame's envelope, parsed
+static nlohmann::json ParseImageFrameHeader(const uint8_t *data, size_t headerSize)
+{
+	std::string header(reinterpret_cast<const char *>(data + IMAGE_FRAME_PREFIX), headerSize);
+	return nlohmann::json::parse(header, nullptr, false);
+}
+
+bool IsImageFrame(const uint8_t *data, size_t size)
+{
+	size_t headerSize;
+	return ImageFrameHeaderSize(data, size, &headerSize);
+}
+
+bool PeekRequest(const uint8_t *data, size_t size, AnalyzeRequest *request)
+{
+	std::string_view message(reinterpret_cast<const char *>(data), size);
+
+	nlohmann::json envelope;
+	size_t headerSize;
+	if (ImageFrameHeaderSize(data, size, &headerSize)) {
+		envelope = ParseImageFrameHeader(data, headerSize);
+	} else if (IsEnvelope(message)) {
+		envelope = nlohmann::json::parse(message.begin(), message.end(), nullptr, false);
+	} else {
+		return ParseCommand(message, request);
+	}
+
+	// The url would point into the parsed envelope, only take what's needed for queueing
+	AnalyzeRequest parsed;
+	parsed.priority = request->priority;
+	if (!ParseEnvelope(envelope, &parsed))
+		return false;
+
+	request->operation = parsed.operation;
+	request->priority = parsed.priority;
+	return true;
+}
+
+void HandleImageFrame(const AnalyzeHandler &handler, const uint8_t *data, size_t size, std::string &out, ResponseEncoding encoding)
+{
+	size_t headerSize;
+	if (!ImageFrameHeaderSize(data, size, &headerSize)) {
+		EncodeEnvelope(out, nullptr, AnalyzeResponse{}, encoding);
+		return;
+	}
+
+	nlohmann::json envelope = ParseImageFrameHeader(data, headerSize);
+
+	nlohmann::json id;
+	if (envelope.is_object() && envelope.contains("id"))
+		id = envelope["id"];
+
+	AnalyzeRequest request;
+	if (!ParseEnvelope(envelope, &request) || (headerSize == size - IMAGE_FRAME_PREFIX)) {
+		EncodeEnvelope(out, id, AnalyzeResponse{}, encoding);
+		return;
+	}
+
+	request.url = std::string_view();
+	request.imageData = data + IMAGE_FRAME_PREFIX + headerSize;
+	request.imageSize = size - IMAGE_FRAME_PREFIX - headerSize;
+
+	if ((request.imageWidth > 0) &&
+		((size_t)request.imageWidth * request.imageHeight * request.imageChannels != request.imageSize)) {
+		EncodeEnvelope(out, id, AnalyzeResponse{}, encoding);
+		return;
+	}
+
+	EncodeEnvelope(out, id, handler(request), encoding);
+}
+
+void HandleCommand(const AnalyzeHandler &handler, std::string_view message, std::string &out, ResponseEncoding encoding)
+{
+	if (IsEnvelope(message)) {
+		nlohmann::json envelope = nlohmann::json::parse(message.begin(), message.end(), nullptr, false);
+
+		nlohmann::json id;
+		if (envelope.is_object() && envelope.contains("id"))
+			id = envelope["id"];
+
+		AnalyzeRequest request;
+		if (!ParseEnvelope(envelope, &request)) {
+			EncodeEnvelope(out, id, AnalyzeResponse{}, encoding);
+			return;
+		}
+
+		EncodeEnvelope(out, id, handler(request), encoding);
+		return;
+	}
+
+	AnalyzeRequest request;
+	if (!ParseCommand(message, &request)) {
+		EncodeResponse(out, AnalyzeResponse{}, encoding);
+		return;
+	}
+
+	EncodeResponse(out, handler(request), encoding);
+}
+
+} // namespace DataCore
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "analyzerequest.h"
+#include "beholdhelper.h"
+#include "responseencoding.h"
+#include "screenclassifier.h"
+#include "voyimage.h"
+
+namespace DataCore {
+
+struct AnalyzeServiceConfig
+{
+	std::string jsonpath;
+	std::string asseturl;
+	int workingSize{1080};
+	bool classify{true};
+};
+
+// The one place requests get turned into analyzer calls; every transport (HTTP, WebSocket, the string protocol) goes through it
+struct IAnalyzeService
+{
+	virtual AnalyzeResponse Analyze(const AnalyzeRequest &request) = 0;
+};
+
+std::shared_ptr<IAnalyzeService> MakeAnalyzeService(std::shared_ptr<IBeholdHelper> beholdHelper,
+													std::shared_ptr<IVoyImageScanner> voyImageScanner,
+													std::shared_ptr<IScreenClassifier> screenClassifier, const AnalyzeServiceConfig &config);
+
+// Adapter for the legacy string protocol: "BEHOLD<url>", "VOYIMAGE<url>", "BOTH<url>", "METRICS", "REINIT" and "FORCEREINIT".
+// The request's url points into message.
+bool ParseCommand(std::string_view message, AnalyzeRequest *request);
+
+// A message can also be a JSON envelope carrying a correlation id, so a client can keep several requests in flight on one
+// connection and match the replies, which then come back in completion order:
+//   {"id": <any>, "command": "BOTH<url>"}  or  {"id": <any>, "operation": "BOTH", "url": "<url>", "classify": false}
+// Either form may add "priority": "interactive" (the default) or "backfill".
+// The reply is {"id": <same id>, "result": <response>}.
+bool IsEnvelope(std::string_view message);
+
+// Binary WebSocket frames can carry the screenshot itself: "DCIM", the envelope's length as a little endian uint32, the envelope
+// (as above, minus url), then the encoded image bytes. Replies are enveloped just like for text envelopes. A client that has
+// the pixels already decoded can send them instead, adding "width", "height" and "channels" (1, 3 or 4, for gray, BGR or BGRA)
+// to the envelope.
+bool IsImageFrame(const uint8_t *data, size_t size);
+
+// Reads just enough of a message (command, envelope or image frame) to cost and queue it: the operation and the priority, which
+// keeps its current value unless the envelope has one. The url is not set.
+bool PeekRequest(const uint8_t *data, size_t size, AnalyzeRequest *request);
+
+// Analyzes the image straight from the frame's memory and appends the encoded reply to out
+void HandleImageFrame(const AnalyzeHandler &handler, const uint8_t *data, size_t size, std::string &out,
+					  ResponseEncoding encoding = ResponseEncoding::Json);
+
+// Runs a string protocol message (or envelope) through handler and appends the encoded reply to out; unknown commands get
+// {"success":false}
+void HandleCommand(const AnalyzeHandler &handler, std::string_view message, std::string &out,
+				   ResponseEncoding encoding = ResponseEncoding::Json);
+
+} // namespace DataCore
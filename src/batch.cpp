@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "batch.h"
+#include "threadpool.h"
+
+namespace DataCore {
+
+namespace fs = std::filesystem;
+
+static bool IsImageFile(const fs::path &path)
+{
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return (extension == ".png") || (extension == ".jpg") || (extension == ".jpeg");
+}
+
+static std::vector<std::string> ListInput(const std::string &input)
+{
+	std::vector<std::string> files;
+
+	if (fs::is_directory(input)) {
+		for (const auto &entry : fs::recursive_directory_iterator(input)) {
+			if (entry.is_regular_file() && IsImageFile(entry.path()))
+				files.push_back(entry.path().string());
+		}
+
+		// Directory order is arbitrary, sorted output diffs cleanly between runs
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	std::ifstream manifest(input);
+	fs::path base = fs::path(input).parent_path();
+	std::string line;
+	while (std::getline(manifest, line)) {
+		if (!line.empty() && (line.back() == '\r'))
+			line.pop_back();
+		if (line.empty() || (line[0] == '#'))
+			continue;
+
+		fs::path path(line);
+		files.push_back(path.is_absolute() ? path.string() : (base / path).string());
+	}
+
+	return files;
+}
+
+static bool ReadFile(const std::string &path, std::vector<uint8_t> *data)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+
+	std::streamsize size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	data->resize((size_t)std::max<std::streamsize>(size, 0));
+	return (bool)file.read(reinterpret_cast<char *>(data->data()), size);
+}
+
+static double RoundMs(double ms)
+{
+	return std::round(ms * 1000) / 1000;
+}
+
+int RunBatch(std::shared_ptr<IAnalyzeService> analyzeService, const BatchOptions &options, std::ostream &stdoutStream)
+{
+	std::vector<std::string> files = ListInput(options.input);
+	if (files.empty()) {
+		std::cerr << "No images found in " << options.input << std::endl;
+		return 1;
+	}
+
+	std::ofstream outputFile;
+	if (!options.output.empty()) {
+		outputFile.open(options.output, std::ios::binary | std::ios::trunc);
+		if (!outputFile) {
+			std::cerr << "Can't write " << options.output << std::endl;
+			return 1;
+		}
+	}
+	std::ostream &output = options.output.empty() ? stdoutStream : outputFile;
+
+	// Lines are finished in any order but written in input order
+	std::vector<std::string> lines(files.size());
+	std::vector<bool> finished(files.size(), false);
+	size_t nextLine = 0;
+
+	size_t unreadable = 0;
+	size_t failed = 0;
+	size_t totalBytes = 0;
+	double readMs = 0;
+	AnalyzeTimings totals;
+	std::mutex mutex;
+
+	auto start = std::chrono::steady_clock::now();
+
+	ThreadPool::Shared().ParallelFor(files.size(), [&](size_t index) {
+		const std::string &path = files[index];
+
+		auto readStart = std::chrono::steady_clock::now();
+		std::vector<uint8_t> data;
+		bool read = ReadFile(path, &data);
+		double fileReadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readStart).count();
+
+		nlohmann::json line;
+		AnalyzeResponse response;
+		bool analyzed = true;
+		if (read) {
+			AnalyzeRequest request;
+			request.operation = options.operation;
+			request.url = path;
+			request.imageData = data.data();
+			request.imageSize = data.size();
+
+			// One image failing must not hold back the lines after it
+			try {
+				response = analyzeService->Analyze(request);
+				line = response;
+			} catch (const std::exception &e) {
+				std::cerr << "Error: " << path << ": " << e.what() << std::endl;
+				analyzed = false;
+				line = nlohmann::json::object();
+				line["url"] = path;
+				line["error"] = e.what();
+				line["success"] = false;
+			}
+		} else {
+			line["url"] = path;
+			line["error"] = "Could not read file";
+			line["success"] = false;
+		}
+
+		line["timings"] = {{"readMs", RoundMs(fileReadMs)},
+						   {"prepareMs", RoundMs(response.timings.prepareMs)},
+						   {"classifyMs", RoundMs(response.timings.classifyMs)},
+						   {"voyageMs", RoundMs(response.timings.voyageMs)},
+						   {"beholdMs", RoundMs(response.timings.beholdMs)}};
+
+		// Paths (and so urls) needn't be UTF-8; those bytes get replaced rather than failing the line
+		std::string dumped = line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		lines[index] = std::move(dumped);
+		finished[index] = true;
+
+		unreadable += read ? 0 : 1;
+		failed += analyzed ? 0 : 1;
+		totalBytes += data.size();
+		readMs += fileReadMs;
+		totals.prepareMs += response.timings.prepareMs;
+		totals.classifyMs += response.timings.classifyMs;
+		totals.voyageMs += response.timings.voyageMs;
+		totals.beholdMs += response.timings.beholdMs;
+
+		for (; (nextLine < lines.size()) && finished[nextLine]; nextLine++) {
+			output << lines[nextLine] << '\n';
+			lines[nextLine] = std::string();
+		}
+	});
+
+	output.flush();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double count = (double)files.size();
+	std::cerr << "Analyzed " << files.size() << " images (" << unreadable << " unreadable, " << failed << " failed) in " << seconds
+			  << "s on " << ThreadPool::Shared().Size() << " threads: " << count / seconds << " images/s, "
+			  << totalBytes / seconds / (1024 * 1024) << " MiB/s" << std::endl;
+	std::cerr << "Mean per image: read " << readMs / count << "ms, prepare " << totals.prepareMs / count << "ms, classify "
+			  << totals.classifyMs / count << "ms, voyage " << totals.voyageMs / count << "ms, behold " << totals.beholdMs / count
+			  << "ms" << std::endl;
+
+	return ((unreadable == 0) && (failed == 0)) ? 0 : 1;
+}
+
+} // namespace DataCore
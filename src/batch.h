@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "analyzeservice.h"
+
+namespace DataCore {
+
+struct BatchOptions
+{
+	// A directory (searched recursively for .png, .jpg and .jpeg files) or a manifest: a text file with one image path per
+	// line, relative paths being relative to the manifest; empty lines and lines starting with '#' are skipped
+	std::string input;
+
+	// JSONL results go to this file, or to RunBatch's stdout stream if empty
+	std::string output;
+
+	AnalyzeOperation operation{AnalyzeOperation::Both};
+};
+
+// Analyzes every image of the batch across the whole ThreadPool and writes one JSON line per image, in input order: the same
+// object the servers reply with (the image's path as url) plus the per stage "timings". A throughput summary goes to stderr.
+// An image the analysis throws on gets a line with its "error" instead. Returns the process exit code: 0 if every image could be
+// read and analyzed, 1 otherwise.
+int RunBatch(std::shared_ptr<IAnalyzeService> analyzeService, const BatchOptions &options, std::ostream &stdoutStream);
+
+} // namespace DataCore
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "beholdhelper.h"
+#include "imagedecode.h"
+#include "opencv_surf/surf.h"
+#include "requestcontext.h"
+
+namespace DataCore {
+
+// Raw dump of a descriptor matrix, the format of the trained *.bin files
+void matwrite(const std::string &filename, const cv::Mat &mat);
+cv::Mat matread(const std::string &filename);
+
+// SURF descriptors of an image, with the settings the trained set was made with
+class Descriptor
+{
+  public:
+	Descriptor()
+	{
+		_detector =
+			cv::makePtr<cv::xxfeatures2d::SURF_Impl>(1200, 4 /*nOctaves*/, 3 /*nOctaveLayers*/, false /*extended*/, true /*upright*/);
+	}
+
+	cv::Mat Describe(cv::InputArray image)
+	{
+		std::vector<cv::KeyPoint> keypoints;
+		cv::Mat descriptors;
+
+		_detector->detectAndCompute(image, cv::noArray(), keypoints, descriptors);
+
+		return descriptors;
+	}
+
+	// Describe a grayscale image whose integral has already been computed
+	cv::Mat Describe(cv::Mat gray, cv::Mat integral)
+	{
+		std::vector<cv::KeyPoint> keypoints;
+		cv::Mat descriptors;
+
+		_detector->detectAndComputeWithIntegral(gray, integral, keypoints, descriptors);
+
+		return descriptors;
+	}
+
+  private:
+	cv::Ptr<cv::xxfeatures2d::SURF_Impl> _detector;
+};
+
+// Matches an image's descriptors against every trained symbol; the symbol most of them matched wins
+class Searcher
+{
+  public:
+	Searcher()
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		_matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
+	}
+
+	bool Add(cv::Mat features, const char *symbol)
+	{
+		_matcher->add(features);
+		_symbols.push_back(symbol);
+		return true;
+	}
+
+	// If given, rivalVotes receives how many features voted for the rival symbol (whether or not it won). A cancelled context
+	// skips the work and reports no match.
+	MatchResult Match(cv::Mat image, const char *rival = nullptr, int *rivalVotes = nullptr, const RequestContext *context = nullptr)
+	{
+		if (IsCancelled(context))
+			return MatchFeatures(cv::Mat(), rival, rivalVotes, context);
+
+		return MatchFeatures(_descriptor.Describe(image), rival, rivalVotes, context);
+	}
+
+	// Match a crop of a prepared image, reusing its grayscale and integral images
+	MatchResult Match(const PreparedImage &image, cv::Rect crop, const char *rival = nullptr, int *rivalVotes = nullptr,
+					  const RequestContext *context = nullptr)
+	{
+		if (image.integral.empty()) {
+			return Match(image.gray(crop), rival, rivalVotes, context);
+		}
+
+		if (IsCancelled(context))
+			return MatchFeatures(cv::Mat(), rival, rivalVotes, context);
+
+		cv::Rect integralCrop(crop.x, crop.y, crop.width + 1, crop.height + 1);
+		return MatchFeatures(_descriptor.Describe(image.gray(crop), image.integral(integralCrop)), rival, rivalVotes, context);
+	}
+
+  private:
+	MatchResult MatchFeatures(cv::Mat features, const char *rival, int *rivalVotes, const RequestContext *context)
+	{
+		if (rivalVotes != nullptr) {
+			*rivalVotes = 0;
+		}
+
+		// Checked again here, describing a large crop takes a while
+		if (features.empty() || IsCancelled(context)) {
+			return {"NO_MATCH", 0};
+		}
+
+		std::vector<cv::DMatch> matches;
+		{
+			// FlannBasedMatcher builds its index on the first match and keeps scratch state, so requests take turns
+			std::lock_guard<std::mutex> lock(_matchMutex);
+			_matcher->match(features, matches);
+		}
+
+		if (matches.size() == 0) {
+			// No matches
+			return {"NO_MATCH", 0};
+		}
+
+		// group by image index
+		std::map<int, int> occurences;
+		for (const auto &match : matches) {		
+			//if (_symbols[match.imgIdx] != "behold_title") {
+				occurences[match.imgIdx]++;
+			//}
+		}
+
+		if ((rival != nullptr) && (rivalVotes != nullptr)) {
+			for (const auto &occurence : occurences) {
+				if (_symbols[occurence.first] == rival)
+					*rivalVotes += occurence.second;
+			}
+		}
+
+		auto max = std::max_element(
+			begin(occurences), end(occurences),
+			[](const decltype(occurences)::value_type &p1, const decltype(occurences)::value_type &p2) { return p1.second < p2.second; });
+
+		return {_symbols[max->first], max->second};
+	}
+
+	Descriptor _descriptor;
+	cv::Ptr<cv::DescriptorMatcher> _matcher;
+	std::mutex _matchMutex;
+
+	// Order here must match order of training in matcher (as it deals in indices
+	// only)
+	std::vector<std::string> _symbols;
+};
+
+} // namespace DataCore
@@ -1,227 +1,427 @@
-#include <boost/asio.hpp>
-#include <boost/beast/core.hpp>
-#include <boost/beast/http.hpp>
-#include <boost/beast/version.hpp>
-#include <chrono>
-#include <cstdlib>
-#include <ctime>
-#include <iostream>
-#include <memory>
-#include <string>
-
-
-#include "httpserver.h"
-
-namespace beast = boost::beast;	  // from <boost/beast.hpp>
-namespace http = beast::http;	  // from <boost/beast/http.hpp>
-namespace net = boost::asio;	  // from <boost/asio.hpp>
-using tcp = boost::asio::ip::tcp; // from <boost/asio/ip/tcp.hpp>
-
-namespace DataCore {
-
-const char HEX2DEC[256] = {
-	/*       0  1  2  3   4  5  6  7   8  9  A  B   C  D  E  F */
-	/* 0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* 1 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* 2 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* 3 */ 0,	1,	2,	3,	4,	5,	6,	7,	8,	9,	-1, -1, -1, -1, -1, -1,
-
-	/* 4 */ -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* 5 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* 6 */ -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* 7 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-
-	/* 8 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* 9 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* A */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* B */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-
-	/* C */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* D */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* E */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	/* F */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
-
-// From here: https://www.codeguru.com/cpp/cpp/algorithms/strings/article.php/c12759/URI-Encoding-and-Decoding.htm
-std::string UriDecode(const std::string &sSrc)
-{
-	// Note from RFC1630: "Sequences which start with a percent
-	// sign but are not followed by two hexadecimal characters
-	// (0-9, A-F) are reserved for future extension"
-
-	const unsigned char *pSrc = (const unsigned char *)sSrc.c_str();
-	const size_t SRC_LEN = sSrc.length();
-	const unsigned char *const SRC_END = pSrc + SRC_LEN;
-	// last decodable '%'
-	const unsigned char *const SRC_LAST_DEC = SRC_END - 2;
-
-	char *const pStart = new char[SRC_LEN];
-	char *pEnd = pStart;
-
-	while (pSrc < SRC_LAST_DEC) {
-		if (*pSrc == '%') {
-			char dec1, dec2;
-			if (-1 != (dec1 = HEX2DEC[*(pSrc + 1)]) && -1 != (dec2 = HEX2DEC[*(pSrc + 2)])) {
-				*pEnd++ = (dec1 << 4) + dec2;
-				pSrc += 3;
-				continue;
-			}
-		}
-
-		*pEnd++ = *pSrc++;
-	}
-
-	// the last 2- chars
-	while (pSrc < SRC_END)
-		*pEnd++ = *pSrc++;
-
-	std::string sResult(pStart, pEnd);
-	delete[] pStart;
-	return sResult;
-}
-
-class http_connection : public std::enable_shared_from_this<http_connection>
-{
-  public:
-	http_connection(tcp::socket socket, std::function<std::string(std::string &&)> lambda) : socket_(std::move(socket)), lambda_(lambda)
-	{
-	}
-
-	// Initiate the asynchronous operations associated with the connection.
-	void start()
-	{
-		read_request();
-		check_deadline();
-	}
-
-  private:
-	// The socket for the currently connected client.
-	tcp::socket socket_;
-
-	// The buffer for performing reads.
-	beast::flat_buffer buffer_{1024};
-
-	// The request message.
-	http::request<http::dynamic_body> request_;
-
-	// The response message.
-	http::response<http::dynamic_body> response_;
-
-	// The timer for putting a deadline on connection processing.
-	net::steady_timer deadline_{socket_.get_executor(), std::chrono::seconds(60)};
-
-	std::function<std::string(std::string &&)> lambda_;
-
-	// Asynchronously receive a complete request message.
-	void read_request()
-	{
-		auto self = shared_from_this();
-
-		http::async_read(socket_, buffer_, request_, [self](beast::error_code ec, std::size_t bytes_transferred) {
-			boost::ignore_unused(bytes_transferred);
-			if (!ec)
-				self->process_request();
-		});
-	}
-
-	// Determine what needs to be done with the request message.
-	void process_request()
-	{
-		response_.version(request_.version());
-		response_.keep_alive(false);
-
-		switch (request_.method()) {
-		case http::verb::get:
-			response_.result(http::status::ok);
-			response_.set(http::field::server, "DataCoreCV");
-			create_response();
-			break;
-
-		default:
-			// We return responses indicating an error if
-			// we do not recognize the request method.
-			response_.result(http::status::bad_request);
-			response_.set(http::field::content_type, "text/plain");
-			beast::ostream(response_.body()) << "Invalid request-method '" << std::string(request_.method_string()) << "'";
-			break;
-		}
-
-		write_response();
-	}
-
-	// Construct a response message based on the program state.
-	void create_response()
-	{
-		auto target = std::string(request_.target());
-		if (target.find("/api/behold?url=") == 0) {
-			response_.set(http::field::content_type, "application/json");
-			std::string url = "BOTH" + UriDecode(target.substr(16));
-			beast::ostream(response_.body()) << lambda_(std::move(url));
-		} else if (target.find("/api/reinit") == 0)  {
-			response_.set(http::field::content_type, "text/plain");
-			std::string url = "REINIT";
-			beast::ostream(response_.body()) << lambda_(std::move(url));
-		} else {
-			response_.result(http::status::not_found);
-			response_.set(http::field::content_type, "text/plain");
-			beast::ostream(response_.body()) << "Invalid request\r\n";
-		}
-	}
-
-	// Asynchronously transmit the response message.
-	void write_response()
-	{
-		auto self = shared_from_this();
-
-		response_.set(http::field::content_length, std::to_string(response_.body().size()));
-
-		http::async_write(socket_, response_, [self](beast::error_code ec, std::size_t) {
-			self->socket_.shutdown(tcp::socket::shutdown_send, ec);
-			self->deadline_.cancel();
-		});
-	}
-
-	// Check whether we have spent enough time on this connection.
-	void check_deadline()
-	{
-		auto self = shared_from_this();
-
-		deadline_.async_wait([self](beast::error_code ec) {
-			if (!ec) {
-				// Close socket to cancel any outstanding operation.
-				self->socket_.close(ec);
-			}
-		});
-	}
-};
-
-// "Loop" forever accepting new connections.
-void http_server(tcp::acceptor &acceptor, tcp::socket &socket, std::function<std::string(std::string &&)> lambda)
-{
-	acceptor.async_accept(socket, [&, lambdacopy = lambda](beast::error_code ec) {
-		if (!ec)
-			std::make_shared<http_connection>(std::move(socket), lambdacopy)->start();
-		http_server(acceptor, socket, lambdacopy);
-	});
-}
-
-bool start_http_server(std::function<std::string(std::string &&)> lambda, const char *addr, unsigned short port) noexcept
-{
-	try {
-		auto const address = net::ip::make_address(addr);
-
-		net::io_context ioc{1};
-
-		tcp::acceptor acceptor{ioc, {address, port}};
-		tcp::socket socket{ioc};
-		http_server(acceptor, socket, lambda);
-
-		ioc.run();
-
-		return true;
-	} catch (std::exception const &e) {
-		std::cerr << "Error: " << e.what() << std::endl;
-		return false;
-	}
-}
-
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "httpserver.h"
+#include "metrics.h"
+#include "networkhelper.h"
+#include "responseencoding.h"
+#include "threadpool.h"
+
+namespace beast = boost::beast;	  // from <boost/beast.hpp>
+namespace http = beast::http;	  // from <boost/beast/http.hpp>
+namespace net = boost::asio;	  // from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp; // from <boost/asio/ip/tcp.hpp>
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+using local = boost::asio::local::stream_protocol;
+#endif
+
+namespace DataCore {
+
+const char HEX2DEC[256] = {
+	/*       0  1  2  3   4  5  6  7   8  9  A  B   C  D  E  F */
+	/* 0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* 1 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* 2 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* 3 */ 0,	1,	2,	3,	4,	5,	6,	7,	8,	9,	-1, -1, -1, -1, -1, -1,
+
+	/* 4 */ -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* 5 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* 6 */ -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* 7 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+
+	/* 8 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* 9 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* A */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* B */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+
+	/* C */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* D */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* E */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	/* F */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+
+// Based on: https://www.codeguru.com/cpp/cpp/algorithms/strings/article.php/c12759/URI-Encoding-and-Decoding.htm
+std::string_view UriDecode(std::string_view src, std::string &buffer)
+{
+	// Note from RFC1630: "Sequences which start with a percent
+	// sign but are not followed by two hexadecimal characters
+	// (0-9, A-F) are reserved for future extension"
+
+	buffer.resize(src.size());
+
+	const unsigned char *pSrc = (const unsigned char *)src.data();
+	const unsigned char *const SRC_END = pSrc + src.size();
+	char *const pStart = &buffer[0];
+	char *pEnd = pStart;
+
+	while (pSrc < SRC_END) {
+		if ((*pSrc == '%') && (SRC_END - pSrc > 2)) {
+			char dec1, dec2;
+			if (-1 != (dec1 = HEX2DEC[*(pSrc + 1)]) && -1 != (dec2 = HEX2DEC[*(pSrc + 2)])) {
+				*pEnd++ = (dec1 << 4) + dec2;
+				pSrc += 3;
+				continue;
+			}
+		}
+
+		*pEnd++ = *pSrc++;
+	}
+
+	return std::string_view(pStart, pEnd - pStart);
+}
+
+// Options come as "name=value" pairs before url=. Everything after url= is the url, so links with unencoded '&' in their own
+// query string still work.
+static void ParseOptions(std::string_view query, AnalyzeOptions *options)
+{
+	while (!query.empty()) {
+		size_t end = std::min(query.find('&'), query.size());
+		std::string_view pair = query.substr(0, end);
+		query.remove_prefix(std::min(end + 1, query.size()));
+
+		size_t equals = pair.find('=');
+		std::string_view name = pair.substr(0, equals);
+		std::string_view value = (equals == std::string_view::npos) ? std::string_view() : pair.substr(equals + 1);
+
+		if (name == "classify")
+			options->classify = !((value == "0") || (value == "false"));
+	}
+}
+
+// Maps a request target onto a typed request without copying; the url is decoded into buffer. False if nothing matches.
+static bool ParseTarget(std::string_view target, std::string &buffer, AnalyzeRequest *request)
+{
+	size_t queryStart = std::min(target.find('?'), target.size());
+	std::string_view path = target.substr(0, queryStart);
+	std::string_view query = target.substr(std::min(queryStart + 1, target.size()));
+
+	if (path == "/api/behold") {
+		static constexpr std::string_view URL_PARAM = "url=";
+
+		size_t urlStart = (query.compare(0, URL_PARAM.size(), URL_PARAM) == 0) ? 0 : query.find("&url=");
+		if (urlStart == std::string_view::npos)
+			return false;
+		if (urlStart > 0)
+			ParseOptions(query.substr(0, urlStart), &request->options);
+		urlStart = (urlStart == 0) ? URL_PARAM.size() : urlStart + 1 + URL_PARAM.size();
+
+		request->operation = AnalyzeOperation::Both;
+		request->url = UriDecode(query.substr(urlStart), buffer);
+		return true;
+	} else if (path == "/api/metrics") {
+		request->operation = AnalyzeOperation::Metrics;
+		return true;
+	} else if (path == "/api/reinit") {
+		request->operation = AnalyzeOperation::ReInit;
+		return true;
+	}
+
+	return false;
+}
+
+// Serves one request over a TCP or Unix domain socket
+template <class Protocol> class http_connection : public std::enable_shared_from_this<http_connection<Protocol>>
+{
+  public:
+	using socket_type = typename Protocol::socket;
+
+	http_connection(socket_type socket, AnalyzeHandler lambda, std::shared_ptr<AdmissionController> admission)
+		: socket_(std::move(socket)), lambda_(lambda), admission_(admission)
+	{
+	}
+
+	// Initiate the asynchronous operations associated with the connection.
+	void start()
+	{
+		read_request();
+		check_deadline();
+	}
+
+  private:
+	// The socket for the currently connected client.
+	socket_type socket_;
+
+	// The buffer for performing reads.
+	beast::flat_buffer buffer_{1024};
+
+	// The request message.
+	http::request<http::dynamic_body> request_;
+
+	// The response message.
+	http::response<http::string_body> response_;
+
+	// The timer for putting a deadline on connection processing.
+	net::steady_timer deadline_{socket_.get_executor(), std::chrono::seconds(60)};
+
+	// Carries the same deadline to the analysis; cancelled early if the client hangs up
+	std::shared_ptr<RequestContext> context_{std::make_shared<RequestContext>(deadline_.expiry())};
+
+	AnalyzeHandler lambda_;
+	std::shared_ptr<AdmissionController> admission_;
+
+	// Decoded request parameters point into this, it is reused for every request on the connection
+	std::string decodeBuffer_;
+
+	// Asynchronously receive a complete request message.
+	void read_request()
+	{
+		auto self = this->shared_from_this();
+
+		http::async_read(socket_, buffer_, request_, [self](beast::error_code ec, std::size_t bytes_transferred) {
+			boost::ignore_unused(bytes_transferred);
+			if (!ec)
+				self->process_request();
+		});
+	}
+
+	// Determine what needs to be done with the request message.
+	void process_request()
+	{
+		response_.version(request_.version());
+		response_.keep_alive(false);
+
+		switch (request_.method()) {
+		case http::verb::get:
+			response_.result(http::status::ok);
+			response_.set(http::field::server, "DataCoreCV");
+			if (!create_response())
+				return;
+			break;
+
+		default:
+			// We return responses indicating an error if
+			// we do not recognize the request method.
+			response_.result(http::status::bad_request);
+			response_.set(http::field::content_type, "text/plain");
+			response_.body() = "Invalid request-method '" + std::string(request_.method_string()) + "'";
+			break;
+		}
+
+		write_response();
+	}
+
+	// Construct a response message based on the program state. Returns false if the work went to the worker pool, which
+	// writes the response once it is done.
+	bool create_response()
+	{
+		auto target = request_.target();
+
+		AnalyzeRequest request;
+		if (!ParseTarget(std::string_view(target.data(), target.size()), decodeBuffer_, &request)) {
+			response_.result(http::status::not_found);
+			response_.set(http::field::content_type, "text/plain");
+			response_.body() = "Invalid request\r\n";
+			return true;
+		}
+
+		auto priority = request_["X-Priority"];
+		if (!priority.empty() && !ParsePriority(std::string_view(priority.data(), priority.size()), &request.priority)) {
+			response_.result(http::status::bad_request);
+			response_.set(http::field::content_type, "text/plain");
+			response_.body() = "Invalid priority\r\n";
+			return true;
+		}
+
+		auto accept = request_[http::field::accept];
+		ResponseEncoding encoding = EncodingFromAccept(std::string_view(accept.data(), accept.size()));
+
+		if ((encoding == ResponseEncoding::Json) && (request.operation == AnalyzeOperation::ReInit))
+			response_.set(http::field::content_type, "text/plain");
+		else
+			response_.set(http::field::content_type, ContentType(encoding));
+
+		// Turn the request away right here, before it queues, if there's already more work than we can get through
+		std::shared_ptr<AdmissionController::Ticket> ticket;
+		if (admission_) {
+			int retryAfter = 1;
+			ticket = admission_->TryAdmit(AdmissionController::EstimateCost(request), &retryAfter, request.priority);
+			if (!ticket) {
+				AnalyzeResponse busy;
+				busy.operation = request.operation;
+				busy.error = "Server busy, retry in " + std::to_string(retryAfter) + "s";
+
+				response_.result(http::status::service_unavailable);
+				response_.set(http::field::retry_after, std::to_string(retryAfter));
+				EncodeResponse(response_.body(), busy, encoding);
+				return true;
+			}
+		}
+
+		// request points into decodeBuffer_, which stays untouched (and alive, through self) until the response is written
+		request.context = context_;
+
+		auto self = this->shared_from_this();
+		ThreadPool::Shared().Post(
+			[self, request, encoding, ticket] {
+				if (self->context_->Cancelled()) {
+					// Nobody is waiting for this anymore, don't start on it
+					Metrics::Instance().Increment("admission.expired");
+					return;
+				}
+
+				if (ticket)
+					ticket->Start();
+
+				std::string body;
+				try {
+					EncodeResponse(body, self->lambda_(request), encoding);
+				} catch (const std::exception &e) {
+					std::cerr << "Error: " << e.what() << std::endl;
+					body.clear();
+					EncodeResponse(body, AnalyzeResponse{}, encoding);
+				}
+
+				net::post(self->socket_.get_executor(), [self, body = std::move(body)]() mutable {
+					self->response_.body() = std::move(body);
+					self->write_response();
+				});
+			},
+			request.priority);
+
+		watch_disconnect();
+		return false;
+	}
+
+	// While the analysis runs the client has nothing more to send, so the socket only becomes readable if it hung up
+	void watch_disconnect()
+	{
+		auto self = this->shared_from_this();
+
+		socket_.async_wait(net::socket_base::wait_read, [self](beast::error_code ec) {
+			if (ec)
+				return;
+
+			char peek;
+			std::size_t read = self->socket_.receive(net::buffer(&peek, 1), net::socket_base::message_peek, ec);
+			if (ec || (read == 0))
+				self->context_->Cancel();
+		});
+	}
+
+	// Asynchronously transmit the response message.
+	void write_response()
+	{
+		auto self = this->shared_from_this();
+
+		response_.set(http::field::content_length, std::to_string(response_.body().size()));
+
+		http::async_write(socket_, response_, [self](beast::error_code ec, std::size_t) {
+			self->socket_.shutdown(net::socket_base::shutdown_send, ec);
+			self->socket_.cancel(ec); // the disconnect watch
+			self->deadline_.cancel();
+		});
+	}
+
+	// Check whether we have spent enough time on this connection.
+	void check_deadline()
+	{
+		auto self = this->shared_from_this();
+
+		deadline_.async_wait([self](beast::error_code ec) {
+			if (!ec) {
+				// Close socket to cancel any outstanding operation.
+				self->context_->Cancel();
+				self->socket_.close(ec);
+			}
+		});
+	}
+};
+
+// "Loop" forever accepting new connections.
+template <class Protocol>
+void http_server(typename Protocol::acceptor &acceptor, typename Protocol::socket &socket, AnalyzeHandler lambda,
+				 const HttpServerOptions &options)
+{
+	acceptor.async_accept(socket, [&, lambdacopy = lambda](beast::error_code ec) {
+		if (!ec)
+			std::make_shared<http_connection<Protocol>>(std::move(socket), lambdacopy, options.admission)->start();
+		http_server<Protocol>(acceptor, socket, lambdacopy, options);
+	});
+}
+
+// One accept loop and the connections it accepted, all on a single thread
+struct http_listener
+{
+	net::io_context ioc{1};
+	tcp::acceptor acceptor{ioc};
+	tcp::socket socket{ioc};
+
+	void listen(const tcp::endpoint &endpoint, bool reusePort)
+	{
+		acceptor.open(endpoint.protocol());
+		acceptor.set_option(net::socket_base::reuse_address(true));
+#ifdef SO_REUSEPORT
+		if (reusePort)
+			acceptor.set_option(net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#endif
+		acceptor.bind(endpoint);
+		acceptor.listen(net::socket_base::max_listen_connections);
+	}
+};
+
+bool start_http_server(AnalyzeHandler lambda, const char *addr, unsigned short port, const HttpServerOptions &options) noexcept
+{
+	try {
+		tcp::endpoint endpoint{net::ip::make_address(addr), port};
+
+		size_t count = std::max<size_t>(options.acceptors, 1);
+#ifndef SO_REUSEPORT
+		if (count > 1) {
+			std::cerr << "SO_REUSEPORT is not supported here, using a single acceptor" << std::endl;
+			count = 1;
+		}
+#endif
+
+		// All bound before any runs, so a port that's taken fails the whole server
+		std::vector<std::unique_ptr<http_listener>> listeners;
+		for (size_t i = 0; i < count; i++) {
+			listeners.push_back(std::make_unique<http_listener>());
+			listeners.back()->listen(endpoint, count > 1);
+			http_server<tcp>(listeners.back()->acceptor, listeners.back()->socket, lambda, options);
+		}
+
+		// Same protocol for co-located clients, served by the first listener's thread
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		std::unique_ptr<local::acceptor> unixAcceptor;
+		std::unique_ptr<local::socket> unixSocket;
+		if (!options.unixPath.empty()) {
+			net::io_context &ioc = listeners[0]->ioc;
+			unixAcceptor = std::make_unique<local::acceptor>(ioc, UnixSocketEndpoint(options.unixPath));
+			unixSocket = std::make_unique<local::socket>(ioc);
+			http_server<local>(*unixAcceptor, *unixSocket, lambda, options);
+		}
+#else
+		if (!options.unixPath.empty())
+			std::cerr << "Unix domain sockets are not supported here, not listening on " << options.unixPath << std::endl;
+#endif
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < count; i++) {
+			threads.emplace_back([&listener = *listeners[i]] { listener.ioc.run(); });
+		}
+
+		listeners[0]->ioc.run();
+
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		return true;
+	} catch (std::exception const &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return false;
+	}
+}
+
 } // namespace DataCore
\ No newline at end of file
@@ -1,8 +1,30 @@
-#include <string>
-
-namespace DataCore {
-
-bool start_http_server(std::function<std::string(std::string &&)> lambda, const char *addr = "0.0.0.0",
-					   unsigned short port = 5000) noexcept;
-
-}
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "admission.h"
+#include "analyzerequest.h"
+
+namespace DataCore {
+
+struct HttpServerOptions
+{
+	// Requests over budget get a 503 with Retry-After; unset admits everything
+	std::shared_ptr<AdmissionController> admission;
+
+	// Listening sockets bound to the same port with SO_REUSEPORT, each accepting and serving its connections on its own thread,
+	// so the kernel spreads new connections across them. 1 is a single plain listener.
+	size_t acceptors{1};
+
+	// Also listen on this Unix domain socket path (a stale socket file there is replaced); empty for none
+	std::string unixPath;
+};
+
+// Percent-decodes a query parameter into buffer, which keeps its capacity between calls, and returns a view of the decoded text
+std::string_view UriDecode(std::string_view src, std::string &buffer);
+
+// The analysis runs on the shared ThreadPool, the socket I/O on the calling thread (plus one thread per extra acceptor)
+bool start_http_server(AnalyzeHandler lambda, const char *addr = "0.0.0.0", unsigned short port = 5000,
+					   const HttpServerOptions &options = HttpServerOptions()) noexcept;
+
+}
@@ -0,0 +1,145 @@
+#include <climits>
+
+#include "imagedecode.h"
+#include "utils.h"
+
+namespace DataCore {
+
+static uint32_t ReadBigEndian(const uint8_t *p, int bytes)
+{
+	uint32_t value = 0;
+	for (int i = 0; i < bytes; i++) {
+		value = (value << 8) | p[i];
+	}
+	return value;
+}
+
+static bool IsJpeg(const uint8_t *data, size_t size)
+{
+	return (size >= 4) && (data[0] == 0xFF) && (data[1] == 0xD8);
+}
+
+cv::Size SniffImageSize(const uint8_t *data, size_t size)
+{
+	static const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+	// PNG: signature, then the IHDR chunk (length, "IHDR", width, height)
+	if ((size >= 24) && (std::equal(PNG_SIGNATURE, PNG_SIGNATURE + 8, data)) && (std::equal(data + 12, data + 16, "IHDR"))) {
+		return cv::Size((int)ReadBigEndian(data + 16, 4), (int)ReadBigEndian(data + 20, 4));
+	}
+
+	// JPEG: walk the marker segments until the first start-of-frame
+	if (IsJpeg(data, size)) {
+		size_t pos = 2;
+		while (pos + 4 <= size) {
+			if (data[pos] != 0xFF)
+				break;
+
+			uint8_t marker = data[pos + 1];
+			if (marker == 0xFF) {
+				// fill byte
+				pos++;
+				continue;
+			}
+
+			if ((marker == 0x01) || ((marker >= 0xD0) && (marker <= 0xD7))) {
+				// standalone markers carry no length
+				pos += 2;
+				continue;
+			}
+
+			size_t length = ReadBigEndian(data + pos + 2, 2);
+			bool isStartOfFrame = (marker >= 0xC0) && (marker <= 0xCF) && (marker != 0xC4) && (marker != 0xC8) && (marker != 0xCC);
+			if (isStartOfFrame) {
+				if (pos + 9 > size)
+					break;
+				return cv::Size((int)ReadBigEndian(data + pos + 7, 2), (int)ReadBigEndian(data + pos + 5, 2));
+			}
+
+			if ((marker == 0xD9) || (marker == 0xDA) || (length < 2))
+				break;
+
+			pos += 2 + length;
+		}
+	}
+
+	return cv::Size();
+}
+
+cv::Mat DecodeImage(const uint8_t *data, size_t size, int workingSize, cv::Size *originalSize)
+{
+	if ((data == nullptr) || (size == 0))
+		return cv::Mat();
+
+	// IMREAD_COLOR makes the codecs strip alpha and 16-bit depth while decoding; orientation is ignored like IMREAD_UNCHANGED did
+	int flags = cv::IMREAD_COLOR | cv::IMREAD_IGNORE_ORIENTATION;
+
+	// Only libjpeg scales while decoding (DCT scaling); other formats get reduced by a resize after a full decode, so
+	// for those we leave the shrinking to the INTER_AREA working resolution step
+	cv::Size dimensions = SniffImageSize(data, size);
+	if ((workingSize > 0) && IsJpeg(data, size) && !dimensions.empty()) {
+		int shortSide = std::min(dimensions.width, dimensions.height);
+		if (shortSide >= workingSize * 8) {
+			flags = cv::IMREAD_REDUCED_COLOR_8 | cv::IMREAD_IGNORE_ORIENTATION;
+		} else if (shortSide >= workingSize * 4) {
+			flags = cv::IMREAD_REDUCED_COLOR_4 | cv::IMREAD_IGNORE_ORIENTATION;
+		} else if (shortSide >= workingSize * 2) {
+			flags = cv::IMREAD_REDUCED_COLOR_2 | cv::IMREAD_IGNORE_ORIENTATION;
+		}
+	}
+
+	// Wrap the encoded bytes without copying them
+	cv::Mat encoded(1, (int)size, CV_8UC1, const_cast<uint8_t *>(data));
+	cv::Mat decoded = cv::imdecode(encoded, flags);
+
+	if (originalSize != nullptr) {
+		*originalSize = dimensions.empty() ? decoded.size() : dimensions;
+	}
+
+	return decoded;
+}
+
+PreparedImage PrepareImage(const uint8_t *data, size_t size, int workingSize)
+{
+	cv::Size inputSize;
+	cv::Mat image = DecodeImage(data, size, workingSize, &inputSize);
+
+	return PrepareImage(image, size, workingSize, inputSize);
+}
+
+PreparedImage PrepareImage(cv::Mat image, size_t fileSize, int workingSize, cv::Size inputSize)
+{
+	PreparedImage prepared;
+	prepared.fileSize = fileSize;
+	prepared.inputSize = inputSize.empty() ? image.size() : inputSize;
+
+	if (image.empty())
+		return prepared;
+
+	ResizeToWorkingResolution(image, workingSize);
+
+	// Some images are encoded with 2 bytes per channel, scale down for template matching to work
+	if (image.depth() == CV_16U) {
+		image.convertTo(image, CV_8U, 0.00390625);
+	}
+
+	// If the image has an alpha channel, remove it
+	if (image.channels() == 4) {
+		cv::cvtColor(image, prepared.bgr, cv::COLOR_BGRA2BGR);
+	} else if (image.channels() == 1) {
+		cv::cvtColor(image, prepared.bgr, cv::COLOR_GRAY2BGR);
+	} else {
+		prepared.bgr = image;
+	}
+
+	cv::cvtColor(prepared.bgr, prepared.gray, cv::COLOR_BGR2GRAY);
+
+	// SURF takes box sums out of this; they only fit in CV_32S up to about 8.4 megapixels
+	if ((double)prepared.gray.total() * 255 < INT_MAX) {
+		cv::integral(prepared.gray, prepared.integral, CV_32S);
+	}
+
+	return prepared;
+}
+
+} // namespace DataCore
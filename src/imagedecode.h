@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+
+namespace DataCore {
+
+// A screenshot decoded and converted once per request, shared read-only by every analyzer
+struct PreparedImage
+{
+	cv::Mat bgr;	  // 8-bit BGR at working resolution
+	cv::Mat gray;	  // bgr converted to grayscale
+	cv::Mat integral; // CV_32S integral of gray; left empty if the sums could overflow
+	cv::Size inputSize; // dimensions of the image as it was sent
+	size_t fileSize{0};
+
+	bool empty() const
+	{
+		return bgr.empty();
+	}
+
+	// Scales a length measured on the image as it was sent down to the working resolution
+	int FromInput(int pixels) const
+	{
+		if (inputSize.height <= 0)
+			return pixels;
+		return (int)((double)pixels * bgr.rows / inputSize.height + 0.5);
+	}
+};
+
+// Reads the pixel dimensions from a PNG or JPEG header without decoding the image; returns an empty size for anything else
+cv::Size SniffImageSize(const uint8_t *data, size_t size);
+
+// Decodes straight to 8-bit BGR (no alpha, no 16-bit intermediate). JPEGs much larger than workingSize are decoded at 1/2, 1/4
+// or 1/8 scale by the codec itself, never going below workingSize on the shorter side. originalSize receives the dimensions
+// of the encoded image, which differ from the returned Mat when a reduced decode was used.
+cv::Mat DecodeImage(const uint8_t *data, size_t size, int workingSize, cv::Size *originalSize = nullptr);
+
+// Decodes, brings to working resolution and builds the grayscale / integral images
+PreparedImage PrepareImage(const uint8_t *data, size_t size, int workingSize);
+
+// Same, for an image that's already decoded (16-bit and alpha channel images are converted here)
+PreparedImage PrepareImage(cv::Mat image, size_t fileSize, int workingSize, cv::Size inputSize = cv::Size());
+
+} // namespace DataCore
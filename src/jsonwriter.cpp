@@ -0,0 +1,237 @@
+#include <charconv>
+#include <string_view>
+
+#include "jsonwriter.h"
+
+namespace DataCore {
+
+// Keys are written in the order nlohmann's std::map backed objects sort them in (bytewise), so the output matches dump()
+
+namespace {
+
+class JsonWriter
+{
+  public:
+	explicit JsonWriter(std::string &out) : _out(out)
+	{
+	}
+
+	void BeginObject()
+	{
+		_out += '{';
+		_first = true;
+	}
+
+	void EndObject()
+	{
+		_out += '}';
+		_first = false;
+	}
+
+	// Key names are our own literals and never need escaping
+	JsonWriter &Key(const char *name)
+	{
+		if (!_first)
+			_out += ',';
+		_first = true;
+		_out += '"';
+		_out += name;
+		_out += "\":";
+		return *this;
+	}
+
+	void Value(bool value)
+	{
+		_out += value ? "true" : "false";
+		_first = false;
+	}
+
+	template <typename T> void Integer(T value)
+	{
+		char buffer[24];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		_out.append(buffer, result.ptr - buffer);
+		_first = false;
+	}
+
+	void Value(const char *value)
+	{
+		Value(std::string_view(value));
+	}
+
+	void Value(std::string_view value)
+	{
+		_out += '"';
+		for (unsigned char c : value) {
+			if (c >= 0x80) {
+				// nlohmann validates (and may reject) UTF-8, leave anything non-ASCII to it
+				_out.resize(_out.size() - 1);
+				_out += nlohmann::json(std::string(value)).dump();
+				_first = false;
+				return;
+			}
+		}
+
+		static const char HEX[] = "0123456789abcdef";
+		for (unsigned char c : value) {
+			switch (c) {
+			case '\b':
+				_out += "\\b";
+				break;
+			case '\t':
+				_out += "\\t";
+				break;
+			case '\n':
+				_out += "\\n";
+				break;
+			case '\f':
+				_out += "\\f";
+				break;
+			case '\r':
+				_out += "\\r";
+				break;
+			case '"':
+				_out += "\\\"";
+				break;
+			case '\\':
+				_out += "\\\\";
+				break;
+			default:
+				if (c <= 0x1F) {
+					_out += "\\u00";
+					_out += HEX[c >> 4];
+					_out += HEX[c & 0xF];
+				} else {
+					_out += (char)c;
+				}
+				break;
+			}
+		}
+		_out += '"';
+		_first = false;
+	}
+
+	// Anything without a fixed shape (the metrics) still goes through nlohmann
+	void Json(const nlohmann::json &value)
+	{
+		_out += value.dump();
+		_first = false;
+	}
+
+  private:
+	std::string &_out;
+	bool _first{true};
+};
+
+void Write(JsonWriter &w, const MatchResult &m)
+{
+	w.BeginObject();
+	w.Key("score").Integer(m.score);
+	w.Key("stars").Integer(m.starcount);
+	w.Key("symbol").Value(m.symbol);
+	w.EndObject();
+}
+
+void Write(JsonWriter &w, const ParsedSkill &p)
+{
+	w.BeginObject();
+	w.Key("Primary").Integer(p.Primary);
+	w.Key("SkillValue").Integer(p.SkillValue);
+	w.EndObject();
+}
+
+void Write(JsonWriter &w, const SearchResults &s)
+{
+	w.BeginObject();
+	w.Key("closebuttons").Integer(s.closebuttons);
+	Write(w.Key("crew1"), s.crew1);
+	Write(w.Key("crew2"), s.crew2);
+	Write(w.Key("crew3"), s.crew3);
+	w.Key("error").Value(s.error);
+	w.Key("fileSize").Integer(s.fileSize);
+	w.Key("input_height").Integer(s.input_height);
+	w.Key("input_width").Integer(s.input_width);
+	Write(w.Key("top"), s.top);
+	w.EndObject();
+}
+
+void Write(JsonWriter &w, const VoySearchResults &s)
+{
+	w.BeginObject();
+	w.Key("antimatter").Integer(s.antimatter);
+	Write(w.Key("cmd"), s.cmd);
+	Write(w.Key("dip"), s.dip);
+	Write(w.Key("eng"), s.eng);
+	w.Key("error").Value(s.error);
+	w.Key("fileSize").Integer(s.fileSize);
+	w.Key("input_height").Integer(s.input_height);
+	w.Key("input_width").Integer(s.input_width);
+	Write(w.Key("med"), s.med);
+	Write(w.Key("sci"), s.sci);
+	Write(w.Key("sec"), s.sec);
+	w.Key("valid").Value(s.valid);
+	w.EndObject();
+}
+
+void Write(JsonWriter &w, const AnalyzeResponse &r)
+{
+	w.BeginObject();
+	if (!r.success) {
+		if (!r.error.empty())
+			w.Key("error").Value(r.error);
+		w.Key("success").Value(false);
+		w.EndObject();
+		return;
+	}
+
+	switch (r.operation) {
+	case AnalyzeOperation::Metrics:
+		w.Key("metrics").Json(r.metrics);
+		w.Key("success").Value(true);
+		break;
+	case AnalyzeOperation::Behold:
+		w.Key("beholdUrl").Value(r.url);
+		Write(w.Key("results"), r.beholdResult);
+		w.Key("success").Value(true);
+		break;
+	case AnalyzeOperation::VoyImage:
+		Write(w.Key("results"), r.voyResult);
+		w.Key("success").Value(true);
+		w.Key("voyImageUrl").Value(r.url);
+		break;
+	case AnalyzeOperation::Both:
+		Write(w.Key("beholdResult"), r.beholdResult);
+		w.Key("durationMs").Integer(r.durationMs);
+		w.Key("screenType").Value(ToString(r.screenType));
+		w.Key("success").Value(true);
+		w.Key("url").Value(r.url);
+		Write(w.Key("voyResult"), r.voyResult);
+		break;
+	default:
+		w.Key("success").Value(true);
+		break;
+	}
+	w.EndObject();
+}
+
+} // namespace
+
+void WriteJson(std::string &out, const AnalyzeResponse &response)
+{
+	JsonWriter w(out);
+	Write(w, response);
+}
+
+void WriteJson(std::string &out, const SearchResults &results)
+{
+	JsonWriter w(out);
+	Write(w, results);
+}
+
+void WriteJson(std::string &out, const VoySearchResults &results)
+{
+	JsonWriter w(out);
+	Write(w, results);
+}
+
+} // namespace DataCore
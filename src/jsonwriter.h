@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+#include "analyzerequest.h"
+
+namespace DataCore {
+
+// Appends the JSON for a response to out, byte for byte what nlohmann::json(response).dump() gives, without building the DOM.
+// out is meant to be reused between responses so its capacity sticks around.
+void WriteJson(std::string &out, const AnalyzeResponse &response);
+void WriteJson(std::string &out, const SearchResults &results);
+void WriteJson(std::string &out, const VoySearchResults &results);
+
+} // namespace DataCore
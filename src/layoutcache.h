@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <opencv2/core.hpp>
+
+#include "metrics.h"
+
+namespace DataCore {
+
+// Remembers where things were found for a given screenshot geometry, so repeat resolutions can skip the full search.
+// Entries are keyed by the (width, height) of the input image; the least recently used entry is dropped once full.
+template <typename T> class LayoutCache
+{
+  public:
+	LayoutCache(const char *name, size_t capacity = 64) : _name(name), _capacity(capacity)
+	{
+	}
+
+	bool Find(cv::Size key, T *layout)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _entries.find({key.width, key.height});
+		if (it == _entries.end())
+			return false;
+
+		it->second.lastUse = ++_clock;
+		*layout = it->second.layout;
+		return true;
+	}
+
+	void Store(cv::Size key, const T &layout)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if ((_entries.size() >= _capacity) && (_entries.find({key.width, key.height}) == _entries.end())) {
+			auto oldest = _entries.begin();
+			for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+				if (it->second.lastUse < oldest->second.lastUse)
+					oldest = it;
+			}
+			_entries.erase(oldest);
+		}
+
+		_entries[{key.width, key.height}] = {layout, ++_clock};
+	}
+
+	void Evict(cv::Size key)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_entries.erase({key.width, key.height});
+	}
+
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_entries.clear();
+	}
+
+	// A hit is only counted once the cached layout has been verified against the image
+	void RecordHit()
+	{
+		Metrics::Instance().Increment(_name + ".hits");
+	}
+
+	void RecordMiss()
+	{
+		Metrics::Instance().Increment(_name + ".misses");
+	}
+
+  private:
+	struct Entry
+	{
+		T layout;
+		uint64_t lastUse{0};
+	};
+
+	std::string _name;
+	size_t _capacity;
+	uint64_t _clock{0};
+	std::mutex _mutex;
+	std::map<std::pair<int, int>, Entry> _entries;
+};
+
+} // namespace DataCore
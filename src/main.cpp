@@ -1,118 +1,176 @@
-#include <iostream>
-#include <chrono> 
-
-#include <opencv2/opencv.hpp>
-
-#include "beholdhelper.h"
-#include "httpserver.h"
-#include "networkhelper.h"
-#include "voyimage.h"
-#include "wsserver.h"
-
-#include "json.hpp"
-#include "args.h"
-
-using namespace DataCore;
-
-int main(int argc, char **argv)
-{
-	args::ArgumentParser parser("DataCore Image Analysis Service");
-	args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
-	args::Flag forceReTrain(parser, "force", "Force redownloading and reparsing all assets", {'f', "force"}, false);
-	args::ValueFlag<std::string> trainPath(parser, "trainpath", "Pathname for folder where train data is stored", {'t', "trainpath"},
-										  "../../../train/");
-	args::ValueFlag<std::string> dataPath(parser, "datapath", "Pathname for folder where input data is stored", {'d', "datapath"},
-										  "../../../data/");
-	args::ValueFlag<std::string> asseturl(parser, "asseturl", "The full URL of the DataCore asset server", {'a', "asseturl"},
-										  "https://assets.datacore.app/");
-	args::ValueFlag<std::string> jsonpath(parser, "jsonpath", "Pathname to website folder where crew.json can be found", {'j', "jsonpath"},
-										  "../../../../website/static/structured/");
-
-	try {
-		parser.ParseCLI(argc, argv);
-	} catch (const args::Help &) {
-		std::cout << parser;
-		return 0;
-	} catch (const args::ParseError &e) {
-		std::cerr << e.what() << std::endl;
-		std::cerr << parser;
-		return 1;
-	}
-
-	NetworkHelper networkHelper;
-	std::shared_ptr<IBeholdHelper> beholdHelper = MakeBeholdHelper(args::get(trainPath), args::get(dataPath));
-	std::shared_ptr<IVoyImageScanner> voyImageScanner = MakeVoyImageScanner(args::get(dataPath));
-
-	// Load all matrices from disk
-	beholdHelper->ReInitialize(args::get(forceReTrain), args::get(jsonpath), args::get(asseturl));
-
-	// Initialize the Tesseract OCR engine
-	voyImageScanner->ReInitialize(args::get(forceReTrain));
-
-	std::cout << "Ready!" << std::endl;
-
-	// Blocking
-	start_http_server([&](std::string &&message) -> std::string {
-		std::cout << "Message received: " << message << std::endl;
-
-		// TODO: there's probably a better / smarter way to implement a protocol handler
-		nlohmann::json j;
-		if (message.find("REINIT") == 0) {
-			// Reinitialize by reloading the asset list from the configured path
-			beholdHelper->ReInitialize(false, args::get(jsonpath), args::get(asseturl));
-			j["success"] = true;
-		} else if (message.find("FORCEREINIT") == 0) {
-			// Force reinitialize by re-downloading and re-parsing all assets
-			beholdHelper->ReInitialize(true, args::get(jsonpath), args::get(asseturl));
-			j["success"] = true;
-		} else if (message.find("BEHOLD") == 0) {
-			// Run the behold analyzer
-			std::string beholdUrl = message.substr(6);
-
-			SearchResults results = beholdHelper->AnalyzeBehold(beholdUrl.c_str());
-			j["beholdUrl"] = beholdUrl;
-			j["results"] = results;
-			j["success"] = true;
-		} else if (message.find("VOYIMAGE") == 0) {
-			// Run the behold analyzer
-			std::string voyImageUrl = message.substr(8);
-
-			VoySearchResults results = voyImageScanner->AnalyzeVoyImage(voyImageUrl.c_str());
-
-			j["voyImageUrl"] = voyImageUrl;
-			j["results"] = results;
-			j["success"] = true;
-		} else if (message.find("BOTH") == 0) {
-			// Run both analyzers
-			std::string url = message.substr(4);
-
-			auto start = std::chrono::high_resolution_clock::now();
-
-			size_t fileSize;
-			cv::Mat query;
-			networkHelper.downloadUrl(url, [&](std::vector<uint8_t> &&v) -> bool {
-				query = cv::imdecode(v, cv::IMREAD_UNCHANGED);
-				fileSize = v.size();
-				return true;
-			});
-
-			VoySearchResults voyResult = voyImageScanner->AnalyzeVoyImage(query, fileSize);
-			SearchResults beholdResult = beholdHelper->AnalyzeBehold(query, fileSize);
-
-			auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
-
-			j["url"] = url;
-			j["beholdResult"] = beholdResult;
-			j["voyResult"] = voyResult;
-			j["success"] = true;
-			j["durationMs"] = duration.count();
-		} else {
-			// unknown message
-			j["success"] = false;
-		}
-
-		return j.dump();
-	});
-
-	return 0;
-}
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+
+#include "admission.h"
+#include "analyzeservice.h"
+#include "batch.h"
+#include "beholdhelper.h"
+#include "httpserver.h"
+#include "screenclassifier.h"
+#include "shmtransport.h"
+#include "threadpool.h"
+#include "voyimage.h"
+#include "wsserver.h"
+
+#include "json.hpp"
+#include "args.h"
+
+using namespace DataCore;
+
+int main(int argc, char **argv)
+{
+	args::ArgumentParser parser("DataCore Image Analysis Service");
+	args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+	args::Flag forceReTrain(parser, "force", "Force redownloading and reparsing all assets", {'f', "force"}, false);
+	args::ValueFlag<std::string> trainPath(parser, "trainpath", "Pathname for folder where train data is stored", {'t', "trainpath"},
+										  "../../../train/");
+	args::ValueFlag<std::string> dataPath(parser, "datapath", "Pathname for folder where input data is stored", {'d', "datapath"},
+										  "../../../data/");
+	args::ValueFlag<std::string> asseturl(parser, "asseturl", "The full URL of the DataCore asset server", {'a', "asseturl"},
+										  "https://assets.datacore.app/");
+	args::ValueFlag<std::string> jsonpath(parser, "jsonpath", "Pathname to website folder where crew.json can be found", {'j', "jsonpath"},
+										  "../../../../website/static/structured/");
+	args::ValueFlag<int> workingSize(parser, "worksize",
+									 "Larger screenshots are scaled down so their shorter side has this many pixels before analysis (0 = never)",
+									 {'w', "worksize"}, 1080);
+	args::Flag noClassify(parser, "noclassify", "Always run both analyzers on /api/behold, instead of only the one the screenshot looks like",
+						  {"noclassify"}, false);
+	args::Flag noEarlyExit(parser, "noearlyexit", "Always run the full behold analysis, even when the screenshot is clearly some other dialog",
+						   {"noearlyexit"}, false);
+	args::ValueFlag<double> earlyExitRatio(parser, "earlyexitratio",
+										   "Skip the behold crew matching when the title got at most this fraction of the winning symbol's votes "
+										   "and a close button was found",
+										   {"earlyexitratio"}, 0.25);
+	args::ValueFlag<double> maxQueuedCost(parser, "maxqueuedcost",
+										  "Turn requests away (HTTP 503) once this much work is queued or running, in units of about one behold "
+										  "analysis (0 = three per core, negative = never)",
+										  {"maxqueuedcost"}, 0);
+	args::ValueFlag<int> maxBackfill(parser, "maxbackfill",
+									 "Most workers running backfill requests (X-Priority: backfill) at once (0 = all cores but one)",
+									 {"maxbackfill"}, 0);
+	args::ValueFlag<int> acceptors(parser, "acceptors",
+								   "HTTP listening sockets sharing port 5000 through SO_REUSEPORT, each on its own I/O thread",
+								   {"acceptors"}, 1);
+	args::ValueFlag<int> wsPort(parser, "wsport", "Also serve the string protocol over WebSocket on this port (0 = none)", {"wsport"}, 0);
+	args::ValueFlag<int> wsMaxConnections(parser, "wsmaxconnections", "Most WebSocket connections served at once", {"wsmaxconnections"},
+										  256);
+	args::ValueFlag<std::string> unixSocket(parser, "unixsocket", "Also serve HTTP on this Unix domain socket path", {"unixsocket"});
+	args::ValueFlag<std::string> wsUnixSocket(parser, "wsunixsocket", "Also serve WebSocket on this Unix domain socket path",
+											  {"wsunixsocket"});
+	args::ValueFlag<std::string> shmName(parser, "shm",
+										 "Serve co-located clients through a shared memory segment with this name, e.g. /dcimage (Linux only)",
+										 {"shm"});
+
+	args::ValueFlag<std::string> batch(parser, "batch",
+									   "Instead of serving, analyze the images in this directory or listed in this manifest file and exit",
+									   {"batch"});
+	args::ValueFlag<std::string> batchOutput(parser, "batchout", "Write the batch's JSONL results to this file instead of stdout",
+											 {"batchout"});
+	args::ValueFlag<std::string> batchOperation(parser, "batchoperation", "What to run on each batch image: BEHOLD, VOYIMAGE or BOTH",
+												{"batchoperation"}, "BOTH");
+
+	try {
+		parser.ParseCLI(argc, argv);
+	} catch (const args::Help &) {
+		std::cout << parser;
+		return 0;
+	} catch (const args::ParseError &e) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return 1;
+	}
+
+	// Batch results may go to stdout, where everything else logs; that goes to stderr then
+	std::ostream batchStdout(std::cout.rdbuf());
+	if (batch && !batchOutput)
+		std::cout.rdbuf(std::cerr.rdbuf());
+
+	EarlyExitPolicy earlyExit;
+	earlyExit.enabled = !args::get(noEarlyExit);
+	earlyExit.maxTitleVoteRatio = args::get(earlyExitRatio);
+
+	std::shared_ptr<IBeholdHelper> beholdHelper = MakeBeholdHelper(args::get(trainPath), args::get(dataPath), earlyExit);
+	std::shared_ptr<IVoyImageScanner> voyImageScanner = MakeVoyImageScanner(args::get(dataPath));
+	std::shared_ptr<IScreenClassifier> screenClassifier = MakeScreenClassifier(args::get(dataPath));
+
+	// Load all matrices from disk
+	beholdHelper->ReInitialize(args::get(forceReTrain), args::get(jsonpath), args::get(asseturl));
+
+	// Initialize the Tesseract OCR engine
+	voyImageScanner->ReInitialize(args::get(forceReTrain));
+
+	screenClassifier->ReInitialize();
+
+	std::cout << "Ready!" << std::endl;
+
+	AnalyzeServiceConfig config;
+	config.jsonpath = args::get(jsonpath);
+	config.asseturl = args::get(asseturl);
+	config.workingSize = args::get(workingSize);
+	config.classify = !args::get(noClassify);
+
+	std::shared_ptr<IAnalyzeService> analyzeService = MakeAnalyzeService(beholdHelper, voyImageScanner, screenClassifier, config);
+
+	if (batch) {
+		BatchOptions batchOptions;
+		batchOptions.input = args::get(batch);
+		batchOptions.output = args::get(batchOutput);
+
+		AnalyzeRequest parsed;
+		if (!ParseCommand(args::get(batchOperation), &parsed) || !parsed.url.empty()) {
+			std::cerr << "Unknown batch operation " << args::get(batchOperation) << std::endl;
+			return 1;
+		}
+		batchOptions.operation = parsed.operation;
+
+		return RunBatch(analyzeService, batchOptions, batchStdout);
+	}
+
+	AnalyzeHandler handler = [&](const AnalyzeRequest &request) -> AnalyzeResponse { return analyzeService->Analyze(request); };
+
+	if (args::get(maxBackfill) > 0)
+		ThreadPool::Shared().SetMaxBackfill((size_t)args::get(maxBackfill));
+
+	std::shared_ptr<AdmissionController> admission;
+	if (args::get(maxQueuedCost) >= 0) {
+		double budget = args::get(maxQueuedCost);
+		admission = std::make_shared<AdmissionController>((budget > 0) ? budget : ThreadPool::Shared().Size() * 3.0);
+	}
+
+	std::thread wsThread;
+	if ((args::get(wsPort) > 0) || !args::get(wsUnixSocket).empty()) {
+		WebSocketServerOptions wsOptions;
+		wsOptions.admission = admission;
+		wsOptions.maxConnections = (size_t)std::max(args::get(wsMaxConnections), 1);
+		wsOptions.unixPath = args::get(wsUnixSocket);
+		unsigned short port = (unsigned short)std::max(args::get(wsPort), 0);
+		wsThread = std::thread([&, port, wsOptions] { start_websocket_server(handler, "0.0.0.0", port, wsOptions); });
+	}
+
+	std::thread shmThread;
+	if (!args::get(shmName).empty()) {
+		ShmServerOptions shmOptions;
+		shmOptions.name = args::get(shmName);
+		shmOptions.admission = admission;
+		shmThread = std::thread([&, shmOptions] { start_shm_server(handler, shmOptions); });
+	}
+
+	HttpServerOptions httpOptions;
+	httpOptions.admission = admission;
+	httpOptions.acceptors = (size_t)std::max(args::get(acceptors), 1);
+	httpOptions.unixPath = args::get(unixSocket);
+
+	// Blocking
+	start_http_server(handler, "0.0.0.0", 5000, httpOptions);
+
+	if (wsThread.joinable())
+		wsThread.join();
+
+	if (shmThread.joinable())
+		shmThread.join();
+
+	return 0;
+}
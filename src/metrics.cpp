@@ -0,0 +1,48 @@
+#include "metrics.h"
+
+namespace DataCore {
+
+Metrics &Metrics::Instance()
+{
+	static Metrics instance;
+	return instance;
+}
+
+void Metrics::Increment(const std::string &name, int64_t delta)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_counters[name] += delta;
+}
+
+int64_t Metrics::Get(const std::string &name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _counters.find(name);
+	return (it == _counters.end()) ? 0 : it->second;
+}
+
+nlohmann::json Metrics::Snapshot()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	nlohmann::json j = nlohmann::json::object();
+	for (const auto &counter : _counters) {
+		j[counter.first] = counter.second;
+	}
+
+	const std::string hitsSuffix = ".hits";
+	for (const auto &counter : _counters) {
+		const std::string &name = counter.first;
+		if ((name.size() <= hitsSuffix.size()) || (name.compare(name.size() - hitsSuffix.size(), hitsSuffix.size(), hitsSuffix) != 0))
+			continue;
+
+		std::string prefix = name.substr(0, name.size() - hitsSuffix.size());
+		auto misses = _counters.find(prefix + ".misses");
+		int64_t total = counter.second + ((misses == _counters.end()) ? 0 : misses->second);
+		j[prefix + ".hit_rate"] = (total == 0) ? 0.0 : (double)counter.second / total;
+	}
+
+	return j;
+}
+
+} // namespace DataCore
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "json.hpp"
+
+namespace DataCore {
+
+// Process-wide named counters, exposed through the "METRICS" command
+class Metrics
+{
+  public:
+	static Metrics &Instance();
+
+	void Increment(const std::string &name, int64_t delta = 1);
+	int64_t Get(const std::string &name);
+
+	// All counters, plus a derived "<name>.hit_rate" for every "<name>.hits" / "<name>.misses" pair
+	nlohmann::json Snapshot();
+
+  private:
+	std::mutex _mutex;
+	std::map<std::string, int64_t> _counters;
+};
+
+} // namespace DataCore
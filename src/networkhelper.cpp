@@ -1,42 +1,111 @@
+#include <algorithm>
 #include <iostream>
-#include <regex>
+#include <stdexcept>
 
-#include "networkhelper.h"
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-#include <boost/algorithm/string.hpp> // for case-insensitive string comparison
+#include "networkhelper.h"
 
 namespace http = boost::beast::http;
 
 namespace DataCore {
 
-struct ParsedURI
+static bool EqualsNoCase(std::string_view a, std::string_view b) noexcept
 {
-	std::string protocol;
-	std::string domain; // only domain must be present
-	std::string port;
-	std::string resource;
-	std::string query; // everything after '?', possibly nothing
-};
-
-ParsedURI parseURI(const std::string &url)
+	if (a.size() != b.size())
+		return false;
+
+	for (size_t i = 0; i < a.size(); i++) {
+		char c = a[i];
+		if ((c >= 'A') && (c <= 'Z'))
+			c = c - 'A' + 'a';
+		if (c != b[i])
+			return false;
+	}
+
+	return true;
+}
+
+bool parseURI(std::string_view url, ParsedURI *result) noexcept
 {
-	ParsedURI result;
-	auto value_or = [](const std::string &value, std::string &&deflt) -> std::string { return (value.empty() ? deflt : value); };
-	// Note: only "http", "https", "ws", and "wss" protocols are supported
-	static const std::regex PARSE_URL{R"((([httpsw]{2,5})://)?([^/ :]+)(:(\d+))?(/([^ ?]+)?)?/?\??([^/ ]+\=[^/ ]+)?)",
-									  std::regex_constants::ECMAScript | std::regex_constants::icase};
-	std::smatch match;
-	if (std::regex_match(url, match, PARSE_URL) && match.size() == 9) {
-		result.protocol = value_or(boost::algorithm::to_lower_copy(std::string(match[2])), "http");
-		result.domain = match[3];
-		const bool is_sequre_protocol = (result.protocol == "https" || result.protocol == "wss");
-		result.port = value_or(match[5], (is_sequre_protocol) ? "443" : "80");
-		result.resource = value_or(match[6], "/");
-		result.query = match[8];
-		assert(!result.domain.empty());
+	static constexpr std::string_view WHITESPACE = " \t\r\n";
+	static constexpr std::string_view PROTOCOLS[] = {"http", "https", "ws", "wss"};
+
+	*result = ParsedURI{};
+
+	size_t first = url.find_first_not_of(WHITESPACE);
+	if (first == std::string_view::npos)
+		return false;
+	url = url.substr(first, url.find_last_not_of(WHITESPACE) - first + 1);
+
+	result->protocol = "http";
+	size_t schemeEnd = url.find("://");
+	if ((schemeEnd != std::string_view::npos) && (url.find_first_of("/?#") > schemeEnd)) {
+		std::string_view scheme = url.substr(0, schemeEnd);
+		auto known = std::find_if(std::begin(PROTOCOLS), std::end(PROTOCOLS),
+								  [scheme](std::string_view protocol) { return EqualsNoCase(scheme, protocol); });
+		if (known == std::end(PROTOCOLS))
+			return false;
+
+		result->protocol = *known;
+		url.remove_prefix(schemeEnd + 3);
+	}
+
+	// The fragment is never sent to the server
+	url = url.substr(0, url.find('#'));
+
+	size_t authorityEnd = std::min(url.find_first_of("/?"), url.size());
+	std::string_view authority = url.substr(0, authorityEnd);
+	url.remove_prefix(authorityEnd);
+
+	size_t at = authority.rfind('@');
+	if (at != std::string_view::npos)
+		authority.remove_prefix(at + 1);
+
+	// Bracketed IPv6 literals contain colons of their own
+	size_t portStart = authority.rfind(':');
+	if ((portStart != std::string_view::npos) && (authority.find(']', portStart) == std::string_view::npos)) {
+		result->port = authority.substr(portStart + 1);
+		authority = authority.substr(0, portStart);
+
+		if (result->port.empty() || (result->port.size() > 5) ||
+			(result->port.find_first_not_of("0123456789") != std::string_view::npos))
+			return false;
 	}
-	return result;
+
+	// Spaces and control characters never make a valid host
+	if (authority.empty() ||
+		std::any_of(authority.begin(), authority.end(), [](char c) { return ((unsigned char)c <= ' ') || ((unsigned char)c == 0x7F); }))
+		return false;
+	if ((authority.size() > 2) && (authority.front() == '[') && (authority.back() == ']'))
+		authority = authority.substr(1, authority.size() - 2);
+	result->domain = authority;
+
+	size_t queryStart = url.find('?');
+	result->resource = url.substr(0, queryStart);
+	if (result->resource.empty())
+		result->resource = "/";
+	if (queryStart != std::string_view::npos)
+		result->query = url.substr(queryStart + 1);
+
+	return true;
+}
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+boost::asio::local::stream_protocol::endpoint UnixSocketEndpoint(const std::string &path)
+{
+#ifndef _WIN32
+	struct stat info;
+	if ((::lstat(path.c_str(), &info) == 0) && S_ISSOCK(info.st_mode))
+		::unlink(path.c_str());
+#endif
+
+	return boost::asio::local::stream_protocol::endpoint(path);
 }
+#endif
 
 NetworkHelper::NetworkHelper()
 {
@@ -44,8 +113,13 @@ NetworkHelper::NetworkHelper()
 
 bool NetworkHelper::performRequest(boost::beast::http::request<boost::beast::http::string_body> &req,
 								   boost::beast::http::response<boost::beast::http::vector_body<uint8_t>> &res, const char *host,
-								   const char *port) noexcept
+								   const char *port, const RequestContext *context) noexcept
 {
+	auto checkCancelled = [context](const char *stage) {
+		if (IsCancelled(context))
+			throw std::runtime_error(std::string("request cancelled before ") + stage);
+	};
+
 	try {
 		// These objects perform our I/O
 		boost::asio::ip::tcp::resolver resolver{ioc};
@@ -58,12 +132,15 @@ bool NetworkHelper::performRequest(boost::beast::http::request<boost::beast::htt
 		}
 
 		// Look up the domain name
+		checkCancelled("resolve");
 		auto const results = resolver.resolve(host, port);
 
 		// Make the connection on the IP address we get from a lookup
+		checkCancelled("connect");
 		boost::asio::connect(stream.next_layer(), results.begin(), results.end());
 
 		// Perform the SSL handshake
+		checkCancelled("handshake");
 		stream.handshake(boost::asio::ssl::stream_base::client);
 
 		// Set some basic fields in the request
@@ -71,12 +148,14 @@ bool NetworkHelper::performRequest(boost::beast::http::request<boost::beast::htt
 		req.set(boost::beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
 
 		// Send the HTTP request to the remote host
+		checkCancelled("write");
 		boost::beast::http::write(stream, req);
 
 		// This buffer is used for reading and must be persisted
 		boost::beast::flat_buffer buffer;
 
 		// Receive the HTTP response
+		checkCancelled("read");
 		boost::beast::http::read(stream, buffer, res);
 
 		// Gracefully close the stream
@@ -108,18 +187,35 @@ bool NetworkHelper::performRequest(boost::beast::http::request<boost::beast::htt
 	return true;
 }
 
-bool NetworkHelper::downloadUrl(const std::string &url, std::function<bool(std::vector<uint8_t> &&)> lambda) noexcept
+bool NetworkHelper::downloadUrl(const std::string &url, std::function<bool(std::vector<uint8_t> &&)> lambda,
+							   const RequestContext *context) noexcept
 {
-	auto uri = parseURI(url);
-	uri.resource = uri.resource + "?" + uri.query;
 	std::cout << "Request downloadUrl: " << url << "\r\n";
 
-	http::request<http::string_body> req{http::verb::get, uri.resource, 11};
+	ParsedURI uri;
+	if (!parseURI(url, &uri)) {
+		std::cerr << "Error during downloadUrl: can't parse url " << url << "\r\n";
+		return false;
+	}
+
+	std::string target(uri.resource);
+	if (!uri.query.empty()) {
+		target += '?';
+		target += uri.query;
+	}
+
+	http::request<http::string_body> req{http::verb::get, target, 11};
 
 	// Declare a container to hold the response
 	http::response<http::vector_body<uint8_t>> res;
 
-	if (!performRequest(req, res, uri.domain.c_str()))
+	// Requests always go over TLS, so only an explicit port overrides 443
+	std::string host(uri.domain);
+	std::string port = uri.port.empty() ? "443" : std::string(uri.port);
+	if (!performRequest(req, res, host.c_str(), port.c_str(), context))
+		return false;
+
+	if (IsCancelled(context))
 		return false;
 
 	if (res.result() != http::status::ok)
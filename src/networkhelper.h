@@ -1,26 +1,52 @@
 #pragma once
 
+#include <string_view>
+
 #include <boost/asio/connect.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/asio/ssl/error.hpp>
 #include <boost/asio/ssl/stream.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
 
+#include "requestcontext.h"
+
 namespace DataCore {
 
+// Views into the parsed url, no copies are made
+struct ParsedURI
+{
+	std::string_view protocol; // always lower case, "http" if the url has none
+	std::string_view domain;
+	std::string_view port; // empty if the url doesn't specify one
+	std::string_view resource; // path, "/" if the url has none
+	std::string_view query; // everything after '?' up to a '#', possibly nothing
+};
+
+// Supports "http", "https", "ws" and "wss" urls, optionally with a port, user info, query and fragment
+bool parseURI(std::string_view url, ParsedURI *result) noexcept;
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+// The endpoint for listening on a Unix domain socket path. A socket file left there by an earlier run is removed first, since
+// binding would fail on it; anything else at path is left alone.
+boost::asio::local::stream_protocol::endpoint UnixSocketEndpoint(const std::string &path);
+#endif
+
 class NetworkHelper
 {
   public:
 	NetworkHelper();
 
-	bool downloadUrl(const std::string &url, std::function<bool(std::vector<uint8_t> &&)> lambda) noexcept;
+	// Gives up between connection stages once the context is cancelled or past its deadline
+	bool downloadUrl(const std::string &url, std::function<bool(std::vector<uint8_t> &&)> lambda,
+					 const RequestContext *context = nullptr) noexcept;
 
   private:
 	bool performRequest(boost::beast::http::request<boost::beast::http::string_body> &req,
 						boost::beast::http::response<boost::beast::http::vector_body<uint8_t>> &res, const char *host,
-						const char *port = "443") noexcept;
+						const char *port = "443", const RequestContext *context = nullptr) noexcept;
 
 	boost::asio::io_context ioc;
 	boost::asio::ssl::context ctx{boost::asio::ssl::context::sslv23_client};
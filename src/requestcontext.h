@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace DataCore {
+
+// Deadline and cancellation for one request. The transport cancels it when the client goes away or its deadline fires; the
+// analysis checks it between stages and gives up early instead of finishing work nobody will read.
+class RequestContext
+{
+  public:
+	using Clock = std::chrono::steady_clock;
+
+	RequestContext() = default;
+
+	explicit RequestContext(Clock::time_point deadline, std::shared_ptr<RequestContext> parent = nullptr)
+		: _deadline(deadline), _parent(parent)
+	{
+	}
+
+	void Cancel()
+	{
+		_cancelled = true;
+	}
+
+	// Cancelled, past the deadline, or the parent (e.g. the connection) is
+	bool Cancelled() const
+	{
+		return _cancelled || (Clock::now() > _deadline) || (_parent && _parent->Cancelled());
+	}
+
+	Clock::time_point Deadline() const
+	{
+		return _deadline;
+	}
+
+  private:
+	std::atomic<bool> _cancelled{false};
+	Clock::time_point _deadline{Clock::time_point::max()};
+	std::shared_ptr<RequestContext> _parent;
+};
+
+// Analysis code takes the context as an optional pointer
+inline bool IsCancelled(const RequestContext *context)
+{
+	return (context != nullptr) && context->Cancelled();
+}
+
+} // namespace DataCore
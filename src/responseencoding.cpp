@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "responseencoding.h"
+#include "jsonwriter.h"
+
+namespace DataCore {
+
+ResponseEncoding EncodingFromAccept(std::string_view accept)
+{
+	if ((accept.find("application/msgpack") != std::string_view::npos) ||
+		(accept.find("application/x-msgpack") != std::string_view::npos))
+		return ResponseEncoding::MsgPack;
+
+	if (accept.find("application/cbor") != std::string_view::npos)
+		return ResponseEncoding::Cbor;
+
+	return ResponseEncoding::Json;
+}
+
+ResponseEncoding EncodingFromSubprotocol(std::string_view offered, std::string_view *protocol)
+{
+	*protocol = std::string_view();
+
+	while (!offered.empty()) {
+		size_t end = std::min(offered.find(','), offered.size());
+		std::string_view name = offered.substr(0, end);
+		offered.remove_prefix(std::min(end + 1, offered.size()));
+
+		size_t first = name.find_first_not_of(' ');
+		if (first == std::string_view::npos)
+			continue;
+		name = name.substr(first, name.find_last_not_of(' ') - first + 1);
+
+		if ((name == "json") || (name == "msgpack") || (name == "cbor")) {
+			*protocol = name;
+			return (name == "msgpack") ? ResponseEncoding::MsgPack : (name == "cbor") ? ResponseEncoding::Cbor : ResponseEncoding::Json;
+		}
+	}
+
+	return ResponseEncoding::Json;
+}
+
+const char *ContentType(ResponseEncoding encoding)
+{
+	switch (encoding) {
+	case ResponseEncoding::MsgPack:
+		return "application/msgpack";
+	case ResponseEncoding::Cbor:
+		return "application/cbor";
+	default:
+		return "application/json";
+	}
+}
+
+void EncodeResponse(std::string &out, const AnalyzeResponse &response, ResponseEncoding encoding)
+{
+	switch (encoding) {
+	case ResponseEncoding::MsgPack:
+		nlohmann::json::to_msgpack(nlohmann::json(response), out);
+		break;
+	case ResponseEncoding::Cbor:
+		nlohmann::json::to_cbor(nlohmann::json(response), out);
+		break;
+	default:
+		WriteJson(out, response);
+		break;
+	}
+}
+
+void EncodeEnvelope(std::string &out, const nlohmann::json &id, const AnalyzeResponse &response, ResponseEncoding encoding)
+{
+	if (encoding != ResponseEncoding::Json) {
+		nlohmann::json envelope{{"id", id}, {"result", response}};
+		if (encoding == ResponseEncoding::MsgPack)
+			nlohmann::json::to_msgpack(envelope, out);
+		else
+			nlohmann::json::to_cbor(envelope, out);
+		return;
+	}
+
+	out += "{\"id\":";
+	out += id.dump();
+	out += ",\"result\":";
+	WriteJson(out, response);
+	out += '}';
+}
+
+} // namespace DataCore
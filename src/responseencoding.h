@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "analyzerequest.h"
+
+namespace DataCore {
+
+enum class ResponseEncoding
+{
+	Json,
+	MsgPack,
+	Cbor
+};
+
+// Picks the encoding from an HTTP Accept header, JSON unless the client asks for application/msgpack or application/cbor
+ResponseEncoding EncodingFromAccept(std::string_view accept);
+
+// Picks the encoding from a Sec-WebSocket-Protocol offer ("json", "msgpack" or "cbor"), the first one we know wins.
+// protocol is set to the name to echo back, or left empty if none was offered.
+ResponseEncoding EncodingFromSubprotocol(std::string_view offered, std::string_view *protocol);
+
+const char *ContentType(ResponseEncoding encoding);
+
+// Appends the response in the given encoding to out. The binary encodings carry the same document the JSON does.
+void EncodeResponse(std::string &out, const AnalyzeResponse &response, ResponseEncoding encoding);
+
+// Same, wrapped as {"id": id, "result": response} for replies to enveloped WebSocket requests
+void EncodeEnvelope(std::string &out, const nlohmann::json &id, const AnalyzeResponse &response, ResponseEncoding encoding);
+
+} // namespace DataCore
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <filesystem>
+
+#include <opencv2/opencv.hpp>
+
+#include "metrics.h"
+#include "screenclassifier.h"
+#include "utils.h"
+
+namespace fs = std::filesystem;
+
+namespace DataCore {
+
+const char *ToString(ScreenType type)
+{
+	switch (type) {
+	case ScreenType::Behold:
+		return "behold";
+	case ScreenType::Voyage:
+		return "voyage";
+	default:
+		return "unknown";
+	}
+}
+
+class ScreenClassifier : public IScreenClassifier
+{
+  public:
+	ScreenClassifier(const char *dataPath) : _dataPath(dataPath)
+	{
+	}
+
+	bool ReInitialize() override;
+	ScreenClassification Classify(const PreparedImage &image) override;
+
+  private:
+	// Height of the thumbnail the probes run on
+	static constexpr int THUMBNAIL_HEIGHT = 360;
+	// Smaller images aren't screenshots, and probes of a few pixels would match about anything (the icons in data/ do)
+	static constexpr int MIN_IMAGE_HEIGHT = 240;
+
+	// A type is picked when its probe scores at least this...
+	static constexpr double CONFIDENT_SCORE = 0.6;
+	// ...and beats the other probe by at least this much. Lower values take clutter for screens, higher ones leave real screens
+	// Unknown; check any change against dcbench "classifier.accuracy".
+	static constexpr double SCORE_MARGIN = 0.15;
+
+	cv::Mat _beholdTitle;
+	cv::Mat _antimatter;
+
+	std::string _dataPath;
+};
+
+bool ScreenClassifier::ReInitialize()
+{
+	_beholdTitle = cv::imread(fs::path(_dataPath + "behold_title.png").make_preferred().string(), cv::IMREAD_GRAYSCALE);
+	_antimatter = cv::imread(fs::path(_dataPath + "antimatter.png").make_preferred().string(), cv::IMREAD_GRAYSCALE);
+
+	return !_beholdTitle.empty() && !_antimatter.empty();
+}
+
+// Best TM_CCOEFF_NORMED score of the template over a few heights between minHeight and maxHeight (as fractions of the strip).
+// With steps = 0 every whole pixel height in between is tried.
+double ProbeTemplate(cv::Mat strip, cv::Mat tpl, double minHeight, double maxHeight, int steps = 5)
+{
+	int first = (int)(strip.rows * minHeight);
+	int count = (steps > 0) ? steps : (int)(strip.rows * maxHeight) - first + 1;
+
+	double best = 0;
+	for (int i = 0; i < count; i++) {
+		int height = (steps > 0) ? (int)(strip.rows * (minHeight + (maxHeight - minHeight) * i / (steps - 1))) : first + i;
+		int width = tpl.cols * height / tpl.rows;
+		if ((height < 4) || (width < 4) || (height > strip.rows) || (width > strip.cols))
+			continue;
+
+		cv::Mat scaled;
+		cv::resize(tpl, scaled, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+
+		cv::Mat res;
+		cv::matchTemplate(strip, scaled, res, cv::TM_CCOEFF_NORMED);
+
+		double minval, maxval;
+		cv::minMaxLoc(res, &minval, &maxval);
+		best = std::max(best, maxval);
+	}
+
+	return best;
+}
+
+ScreenClassification ScreenClassifier::Classify(const PreparedImage &image)
+{
+	ScreenClassification result;
+	if (image.empty() || (image.gray.rows < MIN_IMAGE_HEIGHT) || _beholdTitle.empty() || _antimatter.empty())
+		return result;
+
+	const cv::Mat &gray = image.gray;
+	double scale = std::min(1.0, (double)THUMBNAIL_HEIGHT / gray.rows);
+
+	// Only the top strip is needed for both probes, so that's all we shrink
+	int stripRows = std::max(gray.rows / 5, std::min(80, gray.rows));
+	cv::Mat thumb;
+	cv::resize(SubMat(gray, 0, stripRows, gray.cols / 3, gray.cols * 2 / 3), thumb,
+			   cv::Size(std::max(1, (int)(gray.cols / 3 * scale)), std::max(1, (int)(stripRows * scale))), 0, 0, cv::INTER_AREA);
+
+	// Same regions AnalyzeBehold / AnalyzeVoyImage look at, in thumbnail coordinates. The title fills most of its strip, which is
+	// only ~27 rows here, and its score falls off within a pixel of the right height, so that probe tries every height.
+	int beholdRows = std::min((int)(std::min(gray.rows / 13, 80) * scale) + 1, thumb.rows);
+	result.beholdScore = ProbeTemplate(thumb.rowRange(0, beholdRows), _beholdTitle, 0.4, 0.95, 0);
+	result.voyageScore = ProbeTemplate(thumb, _antimatter, 0.25, 0.5);
+
+	if ((result.beholdScore >= CONFIDENT_SCORE) && (result.beholdScore - result.voyageScore >= SCORE_MARGIN)) {
+		result.type = ScreenType::Behold;
+	} else if ((result.voyageScore >= CONFIDENT_SCORE) && (result.voyageScore - result.beholdScore >= SCORE_MARGIN)) {
+		result.type = ScreenType::Voyage;
+	}
+
+	Metrics::Instance().Increment(std::string("classifier.") + ToString(result.type));
+
+	return result;
+}
+
+std::shared_ptr<IScreenClassifier> MakeScreenClassifier(const std::string &dataPath)
+{
+	return std::make_shared<ScreenClassifier>(dataPath.c_str());
+}
+
+} // namespace DataCore
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "imagedecode.h"
+
+namespace DataCore {
+
+enum class ScreenType
+{
+	Unknown,
+	Behold,
+	Voyage
+};
+
+const char *ToString(ScreenType type);
+
+struct ScreenClassification
+{
+	ScreenType type{ScreenType::Unknown};
+	double beholdScore{0};
+	double voyageScore{0};
+};
+
+// Cheap guess at what kind of screenshot we got, from a small thumbnail and a couple of template probes, so only the relevant
+// analyzer has to run. Returns Unknown whenever the probes don't clearly agree on one type.
+struct IScreenClassifier
+{
+	virtual bool ReInitialize() = 0;
+	virtual ScreenClassification Classify(const PreparedImage &image) = 0;
+};
+
+std::shared_ptr<IScreenClassifier> MakeScreenClassifier(const std::string &dataPath);
+
+} // namespace DataCore
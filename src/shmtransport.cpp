@@ -0,0 +1,779 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "analyzeservice.h"
+#include "metrics.h"
+#include "shmtransport.h"
+#include "threadpool.h"
+
+namespace DataCore {
+
+#ifdef __linux__
+
+// Segment layout: the ShmSegment header, the channel headers, then each channel's request and response ring. Offsets are
+// relative to the start of the segment since every process maps it at a different address.
+
+static const uint32_t SEGMENT_MAGIC = 0x48534344; // "DCSH"
+static const uint32_t SEGMENT_VERSION = 1;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the rings need lock free atomics to work across processes");
+
+// Single producer, single consumer byte ring of ShmRecords. head and tail only ever grow; their difference is the bytes in use.
+// capacity and offset are published for clients; the server goes by its own ShmRingBounds from when it laid out the segment,
+// since a client can write anything here.
+struct ShmRing
+{
+	std::atomic<uint64_t> head;
+	std::atomic<uint64_t> tail;
+	uint64_t capacity;
+	uint64_t offset;
+};
+
+struct ShmChannel
+{
+	// Session id << 32 | pid of the client holding the channel, 0 while free
+	std::atomic<uint64_t> owner;
+
+	// The owner as last seen by the server. A client may only use the channel once the server has reset it for them and set
+	// this to their owner value.
+	std::atomic<uint64_t> acknowledged;
+
+	uint32_t encoding;
+	uint32_t priority;
+
+	ShmRing requests;
+	ShmRing responses;
+
+	sem_t requestSpace;	 // posted by the server whenever it frees request ring space
+	sem_t responseReady; // posted by the server for every reply
+};
+
+struct ShmSegment
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t size;
+	uint32_t channelCount;
+	std::atomic<uint32_t> nextSession;
+
+	// Posted by clients after every request, consumed reply, claim and release; the server scans its channels on each
+	sem_t doorbell;
+};
+
+struct ShmRecord
+{
+	uint64_t id;
+	uint32_t size;
+	uint32_t kind;
+};
+
+static const uint32_t RECORD_MESSAGE = 1;
+static const uint32_t RECORD_WRAP = 2; // the rest of the ring is unused, the next record is at its start
+
+static size_t AlignUp(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static size_t RecordSpace(size_t size)
+{
+	return sizeof(ShmRecord) + AlignUp(size, 8);
+}
+
+static ShmChannel *ChannelAt(ShmSegment *segment, size_t index)
+{
+	uint8_t *base = reinterpret_cast<uint8_t *>(segment);
+	return reinterpret_cast<ShmChannel *>(base + AlignUp(sizeof(ShmSegment), 64) + index * AlignUp(sizeof(ShmChannel), 64));
+}
+
+static uint8_t *RingMemory(ShmSegment *segment, const ShmRingBounds &bounds)
+{
+	return reinterpret_cast<uint8_t *>(segment) + bounds.offset;
+}
+
+static bool RingFits(const ShmRingBounds &bounds, size_t size)
+{
+	return (size <= UINT32_MAX) && (RecordSpace(size) <= bounds.capacity);
+}
+
+// Writer side. Finds contiguous room for a record, wrapping to the start of the ring if the end is too short, so the reader can
+// always use a message in place. nullptr if the ring is too full right now.
+static uint8_t *RingReserve(ShmSegment *segment, ShmRing &ring, const ShmRingBounds &bounds, size_t size, uint64_t *advance)
+{
+	uint64_t head = ring.head.load(std::memory_order_relaxed);
+	uint64_t tail = ring.tail.load(std::memory_order_acquire);
+
+	size_t position = head % bounds.capacity;
+	size_t space = RecordSpace(size);
+	size_t skip = (bounds.capacity - position < space) ? bounds.capacity - position : 0;
+	if (skip + space > bounds.capacity - (head - tail))
+		return nullptr;
+
+	*advance = skip + space;
+	return RingMemory(segment, bounds) + (position + skip) % bounds.capacity + sizeof(ShmRecord);
+}
+
+// Publishes the record set up by RingReserve
+static void RingCommit(ShmSegment *segment, ShmRing &ring, const ShmRingBounds &bounds, uint64_t id, size_t size, uint64_t advance)
+{
+	uint8_t *memory = RingMemory(segment, bounds);
+	uint64_t head = ring.head.load(std::memory_order_relaxed);
+	size_t position = head % bounds.capacity;
+
+	if (advance > RecordSpace(size)) {
+		// A reader treats an end too short for a record header as a wrap marker too
+		if (bounds.capacity - position >= sizeof(ShmRecord)) {
+			ShmRecord *wrap = reinterpret_cast<ShmRecord *>(memory + position);
+			wrap->id = 0;
+			wrap->size = 0;
+			wrap->kind = RECORD_WRAP;
+		}
+		position = 0;
+	}
+
+	ShmRecord *record = reinterpret_cast<ShmRecord *>(memory + position);
+	record->id = id;
+	record->size = (uint32_t)size;
+	record->kind = RECORD_MESSAGE;
+
+	ring.head.store(head + advance, std::memory_order_release);
+}
+
+// A record as the reader sees it. Its header was written by the other process, so it's read once and checked against what was
+// committed before anything is taken from it.
+struct ShmMessage
+{
+	uint64_t id{0};
+	const uint8_t *data{nullptr};
+	size_t size{0};
+	uint64_t space{0}; // what RingPop moves the tail by
+
+	// The header points outside the ring or past what was committed. Nothing can be trusted after it, so popping it drops
+	// everything committed so far.
+	bool malformed{false};
+};
+
+// Reader side: the oldest record, or false if the ring is empty. The message stays valid (and in the ring) until RingPop.
+static bool RingPeek(ShmSegment *segment, ShmRing &ring, const ShmRingBounds &bounds, ShmMessage *message)
+{
+	uint8_t *memory = RingMemory(segment, bounds);
+	for (;;) {
+		uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+		uint64_t head = ring.head.load(std::memory_order_acquire);
+		if (tail == head)
+			return false;
+
+		uint64_t committed = head - tail;
+		size_t position = tail % bounds.capacity;
+		*message = ShmMessage();
+
+		if (bounds.capacity - position < sizeof(ShmRecord)) {
+			if (bounds.capacity - position > committed) {
+				message->malformed = true;
+				message->space = committed;
+				return true;
+			}
+			ring.tail.store(tail + (bounds.capacity - position), std::memory_order_release);
+			continue;
+		}
+
+		const ShmRecord *record = reinterpret_cast<const ShmRecord *>(memory + position);
+		uint64_t id = record->id;
+		size_t size = record->size;
+		uint32_t kind = record->kind;
+
+		if (kind == RECORD_WRAP) {
+			if (bounds.capacity - position > committed) {
+				message->malformed = true;
+				message->space = committed;
+				return true;
+			}
+			ring.tail.store(tail + (bounds.capacity - position), std::memory_order_release);
+			continue;
+		}
+
+		message->id = id;
+		if ((kind != RECORD_MESSAGE) || (position + RecordSpace(size) > bounds.capacity) || (RecordSpace(size) > committed)) {
+			message->malformed = true;
+			message->space = committed;
+			return true;
+		}
+
+		message->data = memory + position + sizeof(ShmRecord);
+		message->size = size;
+		message->space = RecordSpace(size);
+		return true;
+	}
+}
+
+static void RingPop(ShmRing &ring, const ShmMessage &message)
+{
+	uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+	ring.tail.store(tail + message.space, std::memory_order_release);
+}
+
+static void RingReset(ShmRing &ring)
+{
+	ring.head.store(0, std::memory_order_relaxed);
+	ring.tail.store(0, std::memory_order_release);
+}
+
+// False on timeout
+static bool WaitSemaphore(sem_t *semaphore, std::chrono::milliseconds timeout)
+{
+	timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	int64_t nanoseconds = deadline.tv_nsec + (int64_t)(timeout.count() % 1000) * 1000000;
+	deadline.tv_sec += (time_t)(timeout.count() / 1000 + nanoseconds / 1000000000);
+	deadline.tv_nsec = (long)(nanoseconds % 1000000000);
+
+	for (;;) {
+		if (sem_timedwait(semaphore, &deadline) == 0)
+			return true;
+		if (errno != EINTR)
+			return false;
+	}
+}
+
+static ResponseEncoding ChannelEncoding(const ShmChannel *channel)
+{
+	uint32_t encoding = channel->encoding;
+	return (encoding <= (uint32_t)ResponseEncoding::Cbor) ? (ResponseEncoding)encoding : ResponseEncoding::Json;
+}
+
+static bool OwnerAlive(uint64_t owner)
+{
+	pid_t pid = (pid_t)(owner & 0xFFFFFFFF);
+	return (kill(pid, 0) == 0) || (errno != ESRCH);
+}
+
+// The server's bookkeeping for one channel; only the dispatch thread touches the rings, workers hand their replies over here
+struct shm_channel_state
+{
+	std::mutex mutex;
+	uint64_t owner{0};
+
+	// As laid out by create(), never read back from the segment
+	ShmRingBounds requests;
+	ShmRingBounds responses;
+	bool inFlight{false}; // the record at the request ring's tail is being analyzed, in place
+	bool done{false};
+	ShmMessage message; // the request being analyzed
+	std::string response;
+	std::shared_ptr<RequestContext> context;
+};
+
+class shm_server
+{
+  public:
+	shm_server(AnalyzeHandler lambda, const ShmServerOptions &options) : lambda_(lambda), options_(options)
+	{
+	}
+
+	~shm_server()
+	{
+		if (segment_ != nullptr) {
+			munmap(segment_, size_);
+			shm_unlink(options_.name.c_str());
+		}
+	}
+
+	bool create()
+	{
+		size_t channelCount = std::max<size_t>(options_.channels, 1);
+		size_t requestCapacity = AlignUp(std::max<size_t>(options_.requestCapacity, 4096), 64);
+		size_t responseCapacity = AlignUp(std::max<size_t>(options_.responseCapacity, 4096), 64);
+
+		size_t ringsOffset = AlignUp(sizeof(ShmSegment), 64) + channelCount * AlignUp(sizeof(ShmChannel), 64);
+		size_ = ringsOffset + channelCount * (requestCapacity + responseCapacity);
+
+		// A segment left by a server that didn't shut down cleanly has nobody serving it
+		shm_unlink(options_.name.c_str());
+
+		int fd = shm_open(options_.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd < 0) {
+			std::cerr << "Error: shm_open " << options_.name << ": " << strerror(errno) << std::endl;
+			return false;
+		}
+
+		// Pages are only allocated as the rings get used
+		bool sized = (ftruncate(fd, (off_t)size_) == 0);
+		void *memory = sized ? mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+		close(fd);
+		if (memory == MAP_FAILED) {
+			std::cerr << "Error: mapping " << options_.name << ": " << strerror(errno) << std::endl;
+			shm_unlink(options_.name.c_str());
+			return false;
+		}
+
+		segment_ = new (memory) ShmSegment();
+		segment_->size = size_;
+		segment_->channelCount = (uint32_t)channelCount;
+		segment_->nextSession = 1;
+		sem_init(&segment_->doorbell, 1, 0);
+
+		size_t offset = ringsOffset;
+		for (size_t i = 0; i < channelCount; i++) {
+			auto state = std::make_unique<shm_channel_state>();
+			state->requests = {requestCapacity, offset};
+			offset += requestCapacity;
+			state->responses = {responseCapacity, offset};
+			offset += responseCapacity;
+
+			ShmChannel *channel = new (ChannelAt(segment_, i)) ShmChannel();
+			channel->requests.capacity = state->requests.capacity;
+			channel->requests.offset = state->requests.offset;
+			channel->responses.capacity = state->responses.capacity;
+			channel->responses.offset = state->responses.offset;
+
+			sem_init(&channel->requestSpace, 1, 0);
+			sem_init(&channel->responseReady, 1, 0);
+
+			states_.push_back(std::move(state));
+		}
+
+		// Clients check this last, once everything else is in place
+		segment_->version = SEGMENT_VERSION;
+		std::atomic_thread_fence(std::memory_order_release);
+		segment_->magic = SEGMENT_MAGIC;
+
+		return true;
+	}
+
+	void run()
+	{
+		auto lastOwnerCheck = std::chrono::steady_clock::now();
+
+		for (;;) {
+			WaitSemaphore(&segment_->doorbell, std::chrono::milliseconds(100));
+
+			// Clients that died without giving their channel back
+			bool checkOwners = (std::chrono::steady_clock::now() - lastOwnerCheck) > std::chrono::seconds(1);
+			if (checkOwners)
+				lastOwnerCheck = std::chrono::steady_clock::now();
+
+			for (size_t i = 0; i < states_.size(); i++) {
+				service(i, checkOwners);
+			}
+		}
+	}
+
+  private:
+	void service(size_t index, bool checkOwner)
+	{
+		ShmChannel *channel = ChannelAt(segment_, index);
+		shm_channel_state &state = *states_[index];
+		std::lock_guard<std::mutex> lock(state.mutex);
+
+		uint64_t owner = channel->owner.load(std::memory_order_acquire);
+		if (checkOwner && (owner != 0) && !OwnerAlive(owner)) {
+			channel->owner.compare_exchange_strong(owner, 0);
+			owner = channel->owner.load(std::memory_order_acquire);
+		}
+
+		if (state.inFlight) {
+			if (!state.done) {
+				// Whoever sent it is gone; stop the analysis early and reset the channel once it returns
+				if (owner != state.owner)
+					state.context->Cancel();
+				return;
+			}
+
+			if (owner == state.owner) {
+				if (!RingFits(state.responses, state.response.size())) {
+					AnalyzeResponse tooLarge;
+					tooLarge.error = "Reply doesn't fit the response ring";
+					state.response.clear();
+					EncodeEnvelope(state.response, nullptr, tooLarge, ChannelEncoding(channel));
+				}
+
+				uint64_t advance;
+				uint8_t *reply = RingReserve(segment_, channel->responses, state.responses, state.response.size(), &advance);
+				if (reply == nullptr)
+					return; // the client rings the doorbell once it has read some replies
+
+				std::memcpy(reply, state.response.data(), state.response.size());
+				RingCommit(segment_, channel->responses, state.responses, state.message.id, state.response.size(), advance);
+				sem_post(&channel->responseReady);
+
+				RingPop(channel->requests, state.message);
+				sem_post(&channel->requestSpace);
+			}
+
+			state.inFlight = false;
+			state.done = false;
+			state.message = ShmMessage();
+			state.response.clear();
+			state.context.reset();
+		}
+
+		if (owner != state.owner) {
+			// Claimed, given back or taken over; the client waits for the acknowledgement before touching the channel
+			RingReset(channel->requests);
+			RingReset(channel->responses);
+
+			// A client that's slow to notice may still be waiting on these, so they're drained rather than re-initialized
+			while (sem_trywait(&channel->requestSpace) == 0) {
+			}
+			while (sem_trywait(&channel->responseReady) == 0) {
+			}
+
+			state.owner = owner;
+			channel->acknowledged.store(owner, std::memory_order_release);
+		}
+
+		if (owner == 0)
+			return;
+
+		ShmMessage request;
+		if (!RingPeek(segment_, channel->requests, state.requests, &request))
+			return;
+
+		if (request.malformed) {
+			// Answered with an error on the next scan, which also drops it
+			Metrics::Instance().Increment("shm.malformed");
+			AnalyzeResponse malformed;
+			malformed.error = "Malformed request record";
+			EncodeEnvelope(state.response, nullptr, malformed, ChannelEncoding(channel));
+			state.inFlight = true;
+			state.message = request;
+			finish(state);
+			return;
+		}
+
+		dispatch(channel, state, request);
+	}
+
+	// Called with the channel's state locked
+	void dispatch(ShmChannel *channel, shm_channel_state &state, const ShmMessage &message)
+	{
+		const uint8_t *data = message.data;
+		size_t size = message.size;
+		ResponseEncoding encoding = ChannelEncoding(channel);
+
+		// The message stays where the client wrote it until the reply is in: the request ring's tail only moves after that
+		std::function<void(const AnalyzeHandler &, std::string &)> handle = [data, size, encoding](const AnalyzeHandler &handler,
+																									 std::string &out) {
+			if (IsImageFrame(data, size))
+				HandleImageFrame(handler, data, size, out, encoding);
+			else
+				HandleCommand(handler, std::string_view(reinterpret_cast<const char *>(data), size), out, encoding);
+		};
+
+		AnalyzeRequest estimate;
+		estimate.priority = (channel->priority == (uint32_t)TaskPriority::Backfill) ? TaskPriority::Backfill : TaskPriority::Interactive;
+		if (!PeekRequest(data, size, &estimate))
+			estimate.operation = AnalyzeOperation::Metrics;
+
+		state.inFlight = true;
+		state.message = message;
+		state.context =
+			std::make_shared<RequestContext>(RequestContext::Clock::now() + options_.requestTimeout);
+
+		std::shared_ptr<AdmissionController::Ticket> ticket;
+		if (options_.admission) {
+			int retryAfter = 1;
+			ticket = options_.admission->TryAdmit(AdmissionController::EstimateCost(estimate), &retryAfter, estimate.priority);
+			if (!ticket) {
+				// Answer right away, the reply goes out on the next scan
+				handle(
+					[retryAfter](const AnalyzeRequest &request) {
+						AnalyzeResponse busy;
+						busy.operation = request.operation;
+						busy.error = "Server busy, retry in " + std::to_string(retryAfter) + "s";
+						return busy;
+					},
+					state.response);
+				finish(state);
+				return;
+			}
+		}
+
+		ThreadPool::Shared().Post(
+			[this, &state, handle = std::move(handle), ticket, encoding, context = state.context] {
+				if (ticket)
+					ticket->Start();
+
+				std::string out;
+				try {
+					handle(
+						[&lambda = lambda_, &context](const AnalyzeRequest &request) {
+							if (context->Cancelled()) {
+								Metrics::Instance().Increment("admission.expired");
+								AnalyzeResponse cancelled;
+								cancelled.operation = request.operation;
+								cancelled.error = "Cancelled";
+								return cancelled;
+							}
+
+							// Failing here keeps the reply wrapped with the request's id
+							try {
+								AnalyzeRequest withContext = request;
+								withContext.context = context;
+								return lambda(withContext);
+							} catch (const std::exception &e) {
+								std::cerr << "Error: " << e.what() << std::endl;
+								return AnalyzeResponse{};
+							}
+						},
+						out);
+				} catch (const std::exception &e) {
+					// Only encoding the reply is left to fail here
+					std::cerr << "Error: " << e.what() << std::endl;
+					out.clear();
+					EncodeEnvelope(out, nullptr, AnalyzeResponse{}, encoding);
+				}
+
+				std::lock_guard<std::mutex> lock(state.mutex);
+				state.response = std::move(out);
+				finish(state);
+			},
+			estimate.priority);
+	}
+
+	// Called with the channel's state locked, hands the reply to the dispatch thread
+	void finish(shm_channel_state &state)
+	{
+		state.done = true;
+		sem_post(&segment_->doorbell);
+	}
+
+	AnalyzeHandler lambda_;
+	ShmServerOptions options_;
+	ShmSegment *segment_{nullptr};
+	size_t size_{0};
+	std::vector<std::unique_ptr<shm_channel_state>> states_;
+};
+
+bool start_shm_server(AnalyzeHandler lambda, const ShmServerOptions &options) noexcept
+{
+	try {
+		shm_server server(lambda, options);
+		if (!server.create())
+			return false;
+
+		server.run();
+		return true;
+	} catch (const std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return false;
+	}
+}
+
+ShmClient::~ShmClient()
+{
+	Close();
+}
+
+bool ShmClient::Open(const std::string &name, ResponseEncoding encoding, TaskPriority priority, std::chrono::milliseconds timeout)
+{
+	Close();
+
+	_fd = shm_open(name.c_str(), O_RDWR, 0);
+	if (_fd < 0)
+		return false;
+
+	struct stat info;
+	void *memory = MAP_FAILED;
+	if ((fstat(_fd, &info) == 0) && ((size_t)info.st_size >= sizeof(ShmSegment)))
+		memory = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+
+	if (memory == MAP_FAILED) {
+		close(_fd);
+		_fd = -1;
+		return false;
+	}
+
+	_segment = reinterpret_cast<ShmSegment *>(memory);
+	_mappedSize = (size_t)info.st_size;
+
+	bool valid = (_segment->magic == SEGMENT_MAGIC);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (!valid || (_segment->version != SEGMENT_VERSION) || (_segment->size != _mappedSize)) {
+		Close();
+		return false;
+	}
+
+	uint64_t owner = ((uint64_t)_segment->nextSession++ << 32) | (uint32_t)getpid();
+	for (uint32_t i = 0; (i < _segment->channelCount) && (_channel == nullptr); i++) {
+		ShmChannel *channel = ChannelAt(_segment, i);
+		uint64_t expected = 0;
+		if (channel->owner.compare_exchange_strong(expected, owner))
+			_channel = channel;
+	}
+
+	if (_channel == nullptr) {
+		Close();
+		return false;
+	}
+
+	// Read by the server when it dispatches requests, which it only does after acknowledging us
+	_channel->encoding = (uint32_t)encoding;
+	_channel->priority = (uint32_t)priority;
+	sem_post(&_segment->doorbell);
+
+	auto deadline = std::chrono::steady_clock::now() + timeout;
+	while (_channel->acknowledged.load(std::memory_order_acquire) != owner) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			Close();
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// The server's layout, as long as it stays inside what we mapped
+	size_t ringsOffset = AlignUp(sizeof(ShmSegment), 64) + _segment->channelCount * AlignUp(sizeof(ShmChannel), 64);
+	_requests = {_channel->requests.capacity, _channel->requests.offset};
+	_responses = {_channel->responses.capacity, _channel->responses.offset};
+	for (const ShmRingBounds &bounds : {_requests, _responses}) {
+		bool valid = (bounds.capacity >= sizeof(ShmRecord)) && (bounds.capacity % 8 == 0) && (bounds.offset % 8 == 0) &&
+					 (bounds.offset >= ringsOffset) && (bounds.offset <= _mappedSize) && (bounds.capacity <= _mappedSize - bounds.offset);
+		if (!valid) {
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ShmClient::Close()
+{
+	if (_channel != nullptr) {
+		_channel->owner.store(0, std::memory_order_release);
+		sem_post(&_segment->doorbell);
+		_channel = nullptr;
+	}
+
+	if (_segment != nullptr) {
+		munmap(_segment, _mappedSize);
+		_segment = nullptr;
+	}
+
+	if (_fd >= 0) {
+		close(_fd);
+		_fd = -1;
+	}
+}
+
+uint8_t *ShmClient::Reserve(size_t size, std::chrono::milliseconds timeout)
+{
+	if ((_channel == nullptr) || !RingFits(_requests, size))
+		return nullptr;
+
+	auto deadline = std::chrono::steady_clock::now() + timeout;
+	for (;;) {
+		uint8_t *memory = RingReserve(_segment, _channel->requests, _requests, size, &_reservedAdvance);
+		if (memory != nullptr) {
+			_reservedSize = size;
+			return memory;
+		}
+
+		auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+		if ((remaining.count() <= 0) || !WaitSemaphore(&_channel->requestSpace, remaining))
+			return nullptr;
+	}
+}
+
+bool ShmClient::Commit(uint64_t id)
+{
+	if ((_channel == nullptr) || (_reservedAdvance == 0))
+		return false;
+
+	RingCommit(_segment, _channel->requests, _requests, id, _reservedSize, _reservedAdvance);
+	_reservedAdvance = 0;
+	sem_post(&_segment->doorbell);
+	return true;
+}
+
+bool ShmClient::Send(uint64_t id, const uint8_t *data, size_t size, std::chrono::milliseconds timeout)
+{
+	uint8_t *memory = Reserve(size, timeout);
+	if (memory == nullptr)
+		return false;
+
+	std::memcpy(memory, data, size);
+	return Commit(id);
+}
+
+bool ShmClient::Receive(uint64_t *id, std::string *response, std::chrono::milliseconds timeout)
+{
+	if ((_channel == nullptr) || !WaitSemaphore(&_channel->responseReady, timeout))
+		return false;
+
+	ShmMessage message;
+	if (!RingPeek(_segment, _channel->responses, _responses, &message))
+		return false;
+
+	bool valid = !message.malformed;
+	if (valid) {
+		*id = message.id;
+		response->assign(reinterpret_cast<const char *>(message.data), message.size);
+	}
+	RingPop(_channel->responses, message);
+
+	// The server may be holding a reply back for lack of room
+	sem_post(&_segment->doorbell);
+	return valid;
+}
+
+#else
+
+bool start_shm_server(AnalyzeHandler, const ShmServerOptions &) noexcept
+{
+	std::cerr << "The shared memory transport is only available on Linux" << std::endl;
+	return false;
+}
+
+ShmClient::~ShmClient()
+{
+}
+
+bool ShmClient::Open(const std::string &, ResponseEncoding, TaskPriority, std::chrono::milliseconds)
+{
+	return false;
+}
+
+void ShmClient::Close()
+{
+}
+
+uint8_t *ShmClient::Reserve(size_t, std::chrono::milliseconds)
+{
+	return nullptr;
+}
+
+bool ShmClient::Commit(uint64_t)
+{
+	return false;
+}
+
+bool ShmClient::Send(uint64_t, const uint8_t *, size_t, std::chrono::milliseconds)
+{
+	return false;
+}
+
+bool ShmClient::Receive(uint64_t *, std::string *, std::chrono::milliseconds)
+{
+	return false;
+}
+
+#endif
+
+} // namespace DataCore
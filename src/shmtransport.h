@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "admission.h"
+#include "analyzerequest.h"
+#include "responseencoding.h"
+
+namespace DataCore {
+
+// Transport for clients on the same host (Linux only). The server creates a POSIX shared memory segment with a few channels; a
+// client claims one and exchanges the messages the WebSocket server takes (string protocol commands, envelopes and "DCIM"
+// image frames, see analyzeservice.h) through two ring buffers in it. The client writes a screenshot into the segment once and
+// the server analyzes it in place, instead of it going through a socket and the server's read buffers.
+//
+// Requests on one channel are analyzed one after another, in order; a client wanting more in flight claims more channels.
+// Every reply carries the id the client gave its request.
+struct ShmServerOptions
+{
+	// shm_open name of the segment
+	std::string name{"/dcimage"};
+
+	size_t channels{4};
+
+	// Per channel ring sizes; a request must fit in the request ring as a whole
+	size_t requestCapacity{32 * 1024 * 1024};
+	size_t responseCapacity{1024 * 1024};
+
+	// Requests still queued or running this long after they were read are cancelled
+	std::chrono::seconds requestTimeout{60};
+
+	// Requests over budget are answered with an error right away; unset admits everything
+	std::shared_ptr<AdmissionController> admission;
+};
+
+// Creates the segment (replacing one left behind by an earlier run) and serves it on the calling thread. Returns false if the
+// segment can't be set up.
+bool start_shm_server(AnalyzeHandler lambda, const ShmServerOptions &options = ShmServerOptions()) noexcept;
+
+struct ShmSegment;
+struct ShmChannel;
+
+// Where one of a channel's rings lies in the segment
+struct ShmRingBounds
+{
+	uint64_t capacity{0};
+	uint64_t offset{0};
+};
+
+// Client side of one channel
+class ShmClient
+{
+  public:
+	ShmClient() = default;
+	~ShmClient();
+
+	ShmClient(const ShmClient &) = delete;
+	ShmClient &operator=(const ShmClient &) = delete;
+
+	// Maps the server's segment and claims a free channel; false if there's no server or no free channel
+	bool Open(const std::string &name, ResponseEncoding encoding = ResponseEncoding::Json,
+			  TaskPriority priority = TaskPriority::Interactive, std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+	// Gives the channel back; requests not yet answered are dropped
+	void Close();
+
+	// Room for a size byte message straight in the request ring, e.g. to decode an image into. Waits while the ring is full;
+	// nullptr on timeout or if the message could never fit. Nothing is sent until Commit.
+	uint8_t *Reserve(size_t size, std::chrono::milliseconds timeout);
+	bool Commit(uint64_t id);
+
+	// Reserve, copy and Commit
+	bool Send(uint64_t id, const uint8_t *data, size_t size, std::chrono::milliseconds timeout);
+
+	// The next reply, in the encoding given to Open
+	bool Receive(uint64_t *id, std::string *response, std::chrono::milliseconds timeout);
+
+  private:
+	ShmSegment *_segment{nullptr};
+	ShmChannel *_channel{nullptr};
+	ShmRingBounds _requests;
+	ShmRingBounds _responses;
+	size_t _mappedSize{0};
+	int _fd{-1};
+
+	// Between Reserve and Commit
+	size_t _reservedSize{0};
+	uint64_t _reservedAdvance{0};
+};
+
+} // namespace DataCore
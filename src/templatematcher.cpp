@@ -0,0 +1,233 @@
+#include <cmath>
+
+#include "templatematcher.h"
+
+namespace DataCore {
+
+// Resized templates are small, this only guards against a stream of unusual resolutions asking for ever more scales
+static const size_t MAX_CACHED_SCALES = 256;
+
+// Template spectra are padded to the image's DFT size (a 1920 wide strip gives several MB per template and scale); the least
+// recently used ones are dropped beyond this
+static const size_t MAX_CACHED_SPECTRA_BYTES = 32 * 1024 * 1024;
+
+static std::vector<cv::Mat> PaddedSpectra(cv::Mat image, cv::Size dftSize)
+{
+	std::vector<cv::Mat> planes;
+	cv::split(image, planes);
+
+	std::vector<cv::Mat> spectra(planes.size());
+	for (size_t c = 0; c < planes.size(); c++) {
+		cv::Mat padded = cv::Mat::zeros(dftSize, CV_32FC1);
+		cv::Mat roi = padded(cv::Rect(0, 0, image.cols, image.rows));
+		planes[c].convertTo(roi, CV_32F);
+		cv::dft(padded, spectra[c], 0, image.rows);
+	}
+
+	return spectra;
+}
+
+MatchTarget::MatchTarget(cv::Mat image) : _image(image)
+{
+	_dftSize = cv::Size(cv::getOptimalDFTSize(image.cols), cv::getOptimalDFTSize(image.rows));
+}
+
+const std::vector<cv::Mat> &MatchTarget::Spectra()
+{
+	std::call_once(_spectraOnce, [this] { _spectra = PaddedSpectra(_image, _dftSize); });
+	return _spectra;
+}
+
+const cv::Mat &MatchTarget::SquaredIntegral()
+{
+	std::call_once(_squaredOnce, [this] {
+		cv::Mat asFloat;
+		_image.convertTo(asFloat, CV_64F);
+		cv::multiply(asFloat, asFloat, asFloat);
+
+		// Sum the squares over the channels
+		cv::Mat squared = asFloat.reshape(1, (int)asFloat.total());
+		cv::reduce(squared, squared, 1, cv::REDUCE_SUM, CV_64F);
+		cv::integral(squared.reshape(1, _image.rows), _squaredIntegral, CV_64F);
+	});
+	return _squaredIntegral;
+}
+
+void TemplateMatcher::Reset(cv::Mat tpl)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_template = tpl;
+	_generation++;
+	_scaled.clear();
+	_spectra.clear();
+	_spectraLru.clear();
+	_spectraBytes = 0;
+}
+
+std::shared_ptr<TemplateMatcher::ScaledTemplate> TemplateMatcher::GetScaled(int height)
+{
+	cv::Mat tpl;
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		auto it = _scaled.find(height);
+		if (it != _scaled.end())
+			return it->second;
+
+		tpl = _template;
+		generation = _generation;
+	}
+
+	auto scaled = std::make_shared<ScaledTemplate>();
+	if ((height <= 0) || (height == tpl.rows) || tpl.empty()) {
+		scaled->tpl = tpl;
+	} else {
+		cv::resize(tpl, scaled->tpl, cv::Size(tpl.cols * height / tpl.rows, height), 0, 0, cv::INTER_AREA);
+	}
+	scaled->squaredNorm = tpl.empty() ? 0 : cv::norm(scaled->tpl, cv::NORM_L2SQR);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (generation != _generation)
+		return scaled;
+
+	auto it = _scaled.find(height);
+	if (it != _scaled.end())
+		return it->second;
+
+	if (_scaled.size() >= MAX_CACHED_SCALES)
+		_scaled.clear();
+
+	_scaled[height] = scaled;
+	return scaled;
+}
+
+std::shared_ptr<const TemplateMatcher::Spectra> TemplateMatcher::GetSpectra(int height, const ScaledTemplate &scaled, cv::Size dftSize)
+{
+	SpectraKey key(height, dftSize.width, dftSize.height);
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		auto it = _spectra.find(key);
+		if (it != _spectra.end()) {
+			_spectraLru.splice(_spectraLru.begin(), _spectraLru, it->second.lru);
+			return it->second.spectra;
+		}
+
+		generation = _generation;
+	}
+
+	auto spectra = std::make_shared<const Spectra>(PaddedSpectra(scaled.tpl, dftSize));
+	size_t bytes = 0;
+	for (const cv::Mat &plane : *spectra)
+		bytes += plane.total() * plane.elemSize();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (generation != _generation)
+		return spectra;
+
+	auto it = _spectra.find(key);
+	if (it != _spectra.end())
+		return it->second.spectra;
+
+	_spectraLru.push_front(key);
+	_spectra[key] = {spectra, bytes, _spectraLru.begin()};
+	_spectraBytes += bytes;
+
+	// Always keep the entry just added, even if it's over the budget on its own
+	while ((_spectraBytes > MAX_CACHED_SPECTRA_BYTES) && (_spectraLru.size() > 1)) {
+		auto oldest = _spectra.find(_spectraLru.back());
+		_spectraBytes -= oldest->second.bytes;
+		_spectra.erase(oldest);
+		_spectraLru.pop_back();
+	}
+
+	return spectra;
+}
+
+cv::Mat TemplateMatcher::Scaled(int height)
+{
+	return GetScaled(height)->tpl;
+}
+
+bool TemplateMatcher::Match(MatchTarget &target, cv::Mat *result, int height)
+{
+	std::shared_ptr<ScaledTemplate> scaled = GetScaled(height);
+	cv::Mat image = target.Image();
+	const cv::Mat &tpl = scaled->tpl;
+
+	if (tpl.empty() || (tpl.rows > image.rows) || (tpl.cols > image.cols) || (tpl.type() != image.type()))
+		return false;
+
+	cv::Size resultSize(image.cols - tpl.cols + 1, image.rows - tpl.rows + 1);
+
+	// Rough operation counts: direct correlation touches every template pixel for every output pixel, the frequency domain
+	// path costs a forward DFT per channel (shared between templates) plus one inverse DFT
+	double dftArea = (double)target.DftSize().area();
+	double directCost = (double)tpl.total() * resultSize.area() * image.channels();
+	double dftCost = (image.channels() + 1) * dftArea * std::log2(std::max(dftArea, 2.0)) * 2;
+	if (directCost <= dftCost) {
+		cv::matchTemplate(image, tpl, *result, cv::TM_CCORR_NORMED);
+		return true;
+	}
+
+	const std::vector<cv::Mat> &imageSpectra = target.Spectra();
+	std::shared_ptr<const Spectra> tplSpectra = GetSpectra(height, *scaled, target.DftSize());
+
+	// Cross correlation summed over channels: multiply by the conjugate template spectrum and transform back once
+	cv::Mat product;
+	cv::Mat accumulated;
+	for (size_t c = 0; c < imageSpectra.size(); c++) {
+		cv::mulSpectrums(imageSpectra[c], (*tplSpectra)[c], product, 0, true);
+		if (accumulated.empty())
+			accumulated = product.clone();
+		else
+			accumulated += product;
+	}
+
+	cv::Mat correlation;
+	cv::idft(accumulated, correlation, cv::DFT_SCALE | cv::DFT_REAL_OUTPUT, resultSize.height);
+
+	// Normalize like matchTemplate does for TM_CCORR_NORMED, with the window energy taken from the squared-sum integral
+	const cv::Mat &sq = target.SquaredIntegral();
+	result->create(resultSize, CV_32FC1);
+	for (int y = 0; y < resultSize.height; y++) {
+		const double *top = sq.ptr<double>(y);
+		const double *bottom = sq.ptr<double>(y + tpl.rows);
+		const float *corr = correlation.ptr<float>(y);
+		float *out = result->ptr<float>(y);
+
+		for (int x = 0; x < resultSize.width; x++) {
+			double windowSum = bottom[x + tpl.cols] - bottom[x] - top[x + tpl.cols] + top[x];
+			double t = std::sqrt(std::max(windowSum, 0.0) * scaled->squaredNorm);
+			double num = corr[x];
+
+			if (std::fabs(num) < t)
+				num /= t;
+			else if (std::fabs(num) < t * 1.125)
+				num = (num > 0) ? 1 : -1;
+			else
+				num = 0;
+
+			out[x] = (float)num;
+		}
+	}
+
+	return true;
+}
+
+double TemplateMatcher::MatchMax(MatchTarget &target, cv::Point *maxloc, int height)
+{
+	cv::Mat res;
+	if (!Match(target, &res, height))
+		return 0;
+
+	double minval, maxval;
+	cv::Point minloc;
+	cv::minMaxLoc(res, &minval, &maxval, &minloc, maxloc);
+
+	return maxval;
+}
+
+} // namespace DataCore
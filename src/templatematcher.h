@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+namespace DataCore {
+
+// The image side of a template match. Its spectrum and squared-sum integral are only computed when first needed, then shared by
+// every template (and scale) matched against the same image.
+class MatchTarget
+{
+  public:
+	explicit MatchTarget(cv::Mat image);
+
+	cv::Mat Image() const
+	{
+		return _image;
+	}
+
+	cv::Size DftSize() const
+	{
+		return _dftSize;
+	}
+
+	// Per channel CCS spectra of the image, zero padded to DftSize()
+	const std::vector<cv::Mat> &Spectra();
+
+	// CV_64F integral of the per pixel sum of squares over all channels
+	const cv::Mat &SquaredIntegral();
+
+  private:
+	cv::Mat _image;
+	cv::Size _dftSize;
+
+	std::once_flag _spectraOnce;
+	std::vector<cv::Mat> _spectra;
+
+	std::once_flag _squaredOnce;
+	cv::Mat _squaredIntegral;
+};
+
+// A fixed template from data/, correlated with TM_CCORR_NORMED. Everything that only depends on the template is computed once
+// per scale and kept: the resized template, its squared norm and its spectrum for each DFT size it was used with. Small
+// problems go straight to cv::matchTemplate, large ones are correlated in the frequency domain with the cached spectrum.
+// The spectra are padded to the image's DFT size and take several MB each, so only the most recently used ones are kept, up to
+// a fixed number of bytes per matcher.
+class TemplateMatcher
+{
+  public:
+	TemplateMatcher() = default;
+
+	void Reset(cv::Mat tpl);
+
+	bool empty() const
+	{
+		return _template.empty();
+	}
+
+	// The template resized (INTER_AREA, aspect kept) to the given height; 0 means the original size
+	cv::Mat Scaled(int height = 0);
+
+	// Fills result with the same response cv::matchTemplate(TM_CCORR_NORMED) gives; false if the template doesn't fit the image
+	bool Match(MatchTarget &target, cv::Mat *result, int height = 0);
+
+	// Best score and its location, or 0 if the template doesn't fit
+	double MatchMax(MatchTarget &target, cv::Point *maxloc, int height = 0);
+
+  private:
+	struct ScaledTemplate
+	{
+		cv::Mat tpl;
+		double squaredNorm{0};
+	};
+
+	using Spectra = std::vector<cv::Mat>;
+	using SpectraKey = std::tuple<int, int, int>; // height, DFT width, DFT height
+
+	struct CachedSpectra
+	{
+		std::shared_ptr<const Spectra> spectra;
+		size_t bytes{0};
+		std::list<SpectraKey>::iterator lru;
+	};
+
+	// Both look up under _mutex but compute without it, so workers matching cold scales in parallel don't queue behind each
+	// other's resize or DFT; when two compute the same entry, the first one stored wins
+	std::shared_ptr<ScaledTemplate> GetScaled(int height);
+	std::shared_ptr<const Spectra> GetSpectra(int height, const ScaledTemplate &scaled, cv::Size dftSize);
+
+	cv::Mat _template;
+	std::mutex _mutex;
+	uint64_t _generation{0}; // bumped by Reset, so entries computed from the previous template aren't stored
+	std::map<int, std::shared_ptr<ScaledTemplate>> _scaled;
+
+	std::map<SpectraKey, CachedSpectra> _spectra;
+	std::list<SpectraKey> _spectraLru; // most recently used first
+	size_t _spectraBytes{0};
+};
+
+} // namespace DataCore
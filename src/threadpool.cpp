@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <exception>
+
+#include "threadpool.h"
+
+namespace DataCore {
+
+// Priority of the task the current thread is running, passed on to ParallelFor helpers
+static thread_local TaskPriority currentPriority = TaskPriority::Interactive;
+
+ThreadPool::ThreadPool(size_t threadCount) : _maxBackfill(std::max<size_t>(threadCount, 2) - 1)
+{
+	for (size_t i = 0; i < threadCount; i++) {
+		_threads.emplace_back([this] { WorkerLoop(); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_cv.notify_all();
+
+	for (auto &thread : _threads) {
+		thread.join();
+	}
+}
+
+ThreadPool &ThreadPool::Shared()
+{
+	static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+	return pool;
+}
+
+void ThreadPool::Post(std::function<void()> task, TaskPriority priority)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (priority == TaskPriority::Backfill)
+			_backfill.push_back(std::move(task));
+		else
+			_interactive.push_back(std::move(task));
+	}
+	_cv.notify_one();
+}
+
+void ThreadPool::SetMaxBackfill(size_t maxBackfill)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_maxBackfill = std::max<size_t>(maxBackfill, 1);
+	}
+	_cv.notify_all();
+}
+
+size_t ThreadPool::MaxBackfill()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _maxBackfill;
+}
+
+// Called with _mutex held; the cap is lifted while stopping so the queue drains
+bool ThreadPool::CanRunBackfill() const
+{
+	return !_backfill.empty() && (_stopping || (_runningBackfill < _maxBackfill));
+}
+
+void ThreadPool::WorkerLoop()
+{
+	for (;;) {
+		std::function<void()> task;
+		TaskPriority priority;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_cv.wait(lock, [this] { return _stopping || !_interactive.empty() || CanRunBackfill(); });
+			if (_stopping && _interactive.empty() && _backfill.empty())
+				return;
+
+			bool backfillTurn = _interactive.empty() || (_interactiveStreak >= INTERACTIVE_WEIGHT);
+			if (CanRunBackfill() && backfillTurn) {
+				task = std::move(_backfill.front());
+				_backfill.pop_front();
+				_runningBackfill++;
+				_interactiveStreak = 0;
+				priority = TaskPriority::Backfill;
+			} else {
+				task = std::move(_interactive.front());
+				_interactive.pop_front();
+				_interactiveStreak = _backfill.empty() ? 0 : _interactiveStreak + 1;
+				priority = TaskPriority::Interactive;
+			}
+		}
+
+		currentPriority = priority;
+		task();
+		currentPriority = TaskPriority::Interactive;
+
+		if (priority == TaskPriority::Backfill) {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_runningBackfill--;
+			}
+			// A backfill task may have been waiting on the cap
+			_cv.notify_one();
+		}
+	}
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)> &fn)
+{
+	if (count == 0)
+		return;
+
+	struct State
+	{
+		std::atomic<size_t> next{0};
+		size_t done{0};
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+
+	// Helpers may only get scheduled after we returned; they then find no index left and never touch fn
+	auto state = std::make_shared<State>();
+	const std::function<void(size_t)> *body = &fn;
+	auto work = [state, body, count] {
+		for (size_t i = state->next++; i < count; i = state->next++) {
+			std::exception_ptr error;
+			try {
+				(*body)(i);
+			} catch (...) {
+				error = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> lock(state->mutex);
+			if (error && !state->error)
+				state->error = error;
+			if (++state->done == count)
+				state->cv.notify_all();
+		}
+	};
+
+	size_t helpers = std::min(count, _threads.size() + 1) - 1;
+	for (size_t i = 0; i < helpers; i++) {
+		Post(work, currentPriority);
+	}
+
+	work();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->cv.wait(lock, [&] { return state->done == count; });
+
+	// Surface the first failure on the calling thread, like a plain loop would
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+} // namespace DataCore
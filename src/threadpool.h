@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DataCore {
+
+// Interactive work (bot commands somebody is waiting on) goes ahead of backfill (bulk reprocessing of old screenshots)
+enum class TaskPriority
+{
+	Interactive,
+	Backfill
+};
+
+// Fixed set of worker threads shared by the whole process
+class ThreadPool
+{
+  public:
+	explicit ThreadPool(size_t threadCount);
+	~ThreadPool();
+
+	// The process-wide pool, sized to the number of cores
+	static ThreadPool &Shared();
+
+	size_t Size() const
+	{
+		return _threads.size();
+	}
+
+	// Each priority has its own queue. Workers take interactive tasks first but still pick a backfill task after every
+	// INTERACTIVE_WEIGHT interactive ones, and never run more than MaxBackfill() backfill tasks at once, so some workers are
+	// always free for interactive requests.
+	void Post(std::function<void()> task, TaskPriority priority = TaskPriority::Interactive);
+
+	// Defaults to all workers but one (or the only one)
+	void SetMaxBackfill(size_t maxBackfill);
+	size_t MaxBackfill();
+
+	// Runs fn(0) .. fn(count - 1) across the pool. The calling thread takes part and only returns once every index has run,
+	// so this is safe to call from inside a pool task even when all other workers are busy. The helpers are queued with the
+	// calling task's priority.
+	void ParallelFor(size_t count, const std::function<void(size_t)> &fn);
+
+	static const unsigned INTERACTIVE_WEIGHT = 4;
+
+  private:
+	void WorkerLoop();
+	bool CanRunBackfill() const;
+
+	std::vector<std::thread> _threads;
+	std::deque<std::function<void()>> _interactive;
+	std::deque<std::function<void()>> _backfill;
+	size_t _runningBackfill{0};
+	size_t _maxBackfill{1};
+	unsigned _interactiveStreak{0};
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	bool _stopping{false};
+};
+
+} // namespace DataCore
@@ -1,10 +1,30 @@
-#include "utils.h"
-
-namespace DataCore {
-
-cv::Mat SubMat(cv::Mat input, int rowStart, int rowEnd, int colStart, int colEnd)
-{
-	return input(cv::Rect(colStart, rowStart, colEnd - colStart, rowEnd - rowStart));
-}
-
+#include "utils.h"
+
+namespace DataCore {
+
+cv::Mat SubMat(cv::Mat input, int rowStart, int rowEnd, int colStart, int colEnd)
+{
+	return input(SubRect(rowStart, rowEnd, colStart, colEnd));
+}
+
+cv::Rect SubRect(int rowStart, int rowEnd, int colStart, int colEnd)
+{
+	return cv::Rect(colStart, rowStart, colEnd - colStart, rowEnd - rowStart);
+}
+
+double ResizeToWorkingResolution(cv::Mat &image, int workingSize)
+{
+	int shortSide = std::min(image.rows, image.cols);
+	if ((workingSize <= 0) || (shortSide <= workingSize))
+		return 1.0;
+
+	double scale = (double)workingSize / shortSide;
+
+	cv::Mat resized;
+	cv::resize(image, resized, cv::Size((int)(image.cols * scale + 0.5), (int)(image.rows * scale + 0.5)), 0, 0, cv::INTER_AREA);
+	image = resized;
+
+	return scale;
+}
+
 } // namespace DataCore
\ No newline at end of file
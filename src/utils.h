@@ -1,7 +1,12 @@
-#include <opencv2/opencv.hpp>
-
-namespace DataCore {
-
-cv::Mat SubMat(cv::Mat input, int rowStart, int rowEnd, int colStart, int colEnd);
-
-}
+#include <opencv2/opencv.hpp>
+
+namespace DataCore {
+
+cv::Mat SubMat(cv::Mat input, int rowStart, int rowEnd, int colStart, int colEnd);
+cv::Rect SubRect(int rowStart, int rowEnd, int colStart, int colEnd);
+
+// Shrinks (never enlarges) the image so its shorter side is at most workingSize, and returns the scale that was applied.
+// A workingSize of 0 leaves the image untouched.
+double ResizeToWorkingResolution(cv::Mat &image, int workingSize);
+
+}
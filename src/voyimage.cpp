@@ -1,312 +1,486 @@
-#include <algorithm>
-#include <filesystem>
-#include <iostream>
-#include <map>
-#include <sstream>
-#include <vector>
-
-#include <leptonica/allheaders.h>
-#include <opencv2/opencv.hpp>
-#include <tesseract/baseapi.h>
-
-#include "networkhelper.h"
-#include "utils.h"
-#include "voyimage.h"
-
-namespace fs = std::filesystem;
-
-namespace DataCore {
-
-class VoyImageScanner : public IVoyImageScanner
-{
-  public:
-	VoyImageScanner(const char *dataPath) : _dataPath(dataPath)
-	{
-	}
-
-	~VoyImageScanner();
-
-	bool ReInitialize(bool forceReTraining) override;
-	VoySearchResults AnalyzeVoyImage(const char *url) override;
-	VoySearchResults AnalyzeVoyImage(cv::Mat query, size_t fileSize) override;
-
-  private:
-	int MatchTop(cv::Mat top);
-	bool MatchBottom(cv::Mat bottom, VoySearchResults *result);
-	int OCRNumber(cv::Mat SkillValue, const std::string &name = "");
-	int HasStar(cv::Mat skillImg, const std::string &skillName = "");
-
-	NetworkHelper _networkHelper;
-	std::shared_ptr<tesseract::TessBaseAPI> _tesseract;
-
-	cv::Mat _skill_cmd;
-	cv::Mat _skill_dip;
-	cv::Mat _skill_eng;
-	cv::Mat _skill_med;
-	cv::Mat _skill_sci;
-	cv::Mat _skill_sec;
-	cv::Mat _antimatter;
-
-	std::string _dataPath;
-};
-
-VoyImageScanner::~VoyImageScanner()
-{
-	if (_tesseract) {
-		_tesseract->End();
-		_tesseract.reset();
-	}
-}
-
-bool VoyImageScanner::ReInitialize(bool forceReTraining)
-{
-	_skill_cmd = cv::imread(fs::path(_dataPath + "cmd.png").make_preferred().string());
-	_skill_dip = cv::imread(fs::path(_dataPath + "dip.png").make_preferred().string());
-	_skill_eng = cv::imread(fs::path(_dataPath + "eng.png").make_preferred().string());
-	_skill_med = cv::imread(fs::path(_dataPath + "med.png").make_preferred().string());
-	_skill_sci = cv::imread(fs::path(_dataPath + "sci.png").make_preferred().string());
-	_skill_sec = cv::imread(fs::path(_dataPath + "sec.png").make_preferred().string());
-	_antimatter = cv::imread(fs::path(_dataPath + "antimatter.png").make_preferred().string());
-
-	_tesseract = std::make_shared<tesseract::TessBaseAPI>();
-
-	if (_tesseract->Init(fs::path(_dataPath + "tessdata").make_preferred().string().c_str(), "Eurostile")) {
-		// "Could not initialize tesseract"
-		return false;
-	}
-
-	//_tesseract->DefaultPageSegMode = PageSegMode.SingleWord;
-
-	_tesseract->SetVariable("tessedit_char_whitelist", "0123456789");
-	_tesseract->SetVariable("classify_bln_numeric_mode", "1");
-
-	return true;
-}
-
-double ScaleInvariantTemplateMatch(cv::Mat refMat, cv::Mat tplMat, cv::Point *maxloc, double threshold = 0.8)
-{
-	cv::Mat res(refMat.rows - tplMat.rows + 1, refMat.cols - tplMat.cols + 1, CV_32FC1);
-
-	// Threshold out the faded stars
-	cv::threshold(refMat, refMat, 100, 1, cv::THRESH_TOZERO);
-
-	cv::matchTemplate(refMat, tplMat, res, cv::TM_CCORR_NORMED);
-	cv::threshold(res, res, threshold, 1, cv::THRESH_TOZERO);
-
-	double minval, maxval;
-	cv::Point minloc;
-	cv::minMaxLoc(res, &minval, &maxval, &minloc, maxloc);
-
-	return maxval;
-}
-
-int VoyImageScanner::OCRNumber(cv::Mat SkillValue, const std::string &name)
-{
-	_tesseract->SetImage((uchar *)SkillValue.data, SkillValue.size().width, SkillValue.size().height, SkillValue.channels(),
-						 (int)SkillValue.step1());
-	_tesseract->SetSourceResolution(70);
-	_tesseract->Recognize(0);
-	const char *out = _tesseract->GetUTF8Text();
-
-	// std::cout << "For " << name << "OCR got " << out << std::endl;
-
-	return std::atoi(out);
-}
-
-int VoyImageScanner::HasStar(cv::Mat skillImg, const std::string &skillName)
-{
-	cv::Mat center =
-		SubMat(skillImg, (skillImg.rows / 2) - 10, (skillImg.rows / 2) + 10, (skillImg.cols / 2) - 10, (skillImg.cols / 2) + 10);
-
-	auto mean = cv::mean(center);
-
-	if (mean.val[0] + mean.val[1] + mean.val[2] < 10) {
-		return 0;
-	} else if (mean.val[0] < 10) {
-		std::cout << "Primary " << mean.val[0] << " " << mean.val[1] << " " << mean.val[2] << "\n";
-		return 1; // Primary
-	} else if (mean.val[0] + mean.val[1] + mean.val[2] > 100) {
-		std::cout << "Secondary " << mean.val[0] << " " << mean.val[1] << " " << mean.val[2] << "\n";
-		return 2; // Secondary
-	} else {
-		// not sure... hmmm
-		return -1;
-	}
-}
-
-bool VoyImageScanner::MatchBottom(cv::Mat bottom, VoySearchResults *result)
-{
-	int minHeight = bottom.rows * 3 / 15;
-	int maxHeight = bottom.rows * 5 / 15;
-	int stepHeight = bottom.rows / 30;
-
-	cv::Point maxlocCmd;
-	cv::Point maxlocSci;
-	int scaledWidth = 0;
-	int height = minHeight;
-	for (; height <= maxHeight; height += stepHeight) {
-		cv::Mat scaledCmd;
-		cv::resize(_skill_cmd, scaledCmd, cv::Size(_skill_cmd.cols * height / _skill_cmd.rows, height), 0, 0, cv::INTER_AREA);
-		cv::Mat scaledSci;
-		cv::resize(_skill_sci, scaledSci, cv::Size(_skill_sci.cols * height / _skill_sci.rows, height), 0, 0, cv::INTER_AREA);
-
-		double maxvalCmd = ScaleInvariantTemplateMatch(bottom, scaledCmd, &maxlocCmd);
-		double maxvalSci = ScaleInvariantTemplateMatch(bottom, scaledSci, &maxlocSci);
-
-		if ((maxvalCmd > 0.9) && (maxvalSci > 0.9)) {
-			scaledWidth = scaledSci.cols;
-			break;
-		}
-	}
-
-	if (scaledWidth == 0) {
-		return false;
-	}
-
-	double widthScale = (double)scaledWidth / _skill_sci.cols;
-
-	result->cmd.SkillValue = OCRNumber(
-		SubMat(bottom, maxlocCmd.y, maxlocCmd.y + height, maxlocCmd.x - (scaledWidth * 5), maxlocCmd.x - (scaledWidth / 8)), "cmd");
-	result->cmd.Primary = HasStar(
-		SubMat(bottom, maxlocCmd.y, maxlocCmd.y + height, maxlocCmd.x + (scaledWidth * 9 / 8), maxlocCmd.x + (scaledWidth * 5 / 2)), "cmd");
-
-	result->dip.SkillValue = OCRNumber(SubMat(bottom, maxlocCmd.y + height, maxlocSci.y, maxlocCmd.x - (scaledWidth * 5),
-											  (int)(maxlocCmd.x - (_skill_dip.cols - _skill_sci.cols) * widthScale)),
-									   "dip");
-	result->dip.Primary = HasStar(
-		SubMat(bottom, maxlocCmd.y + height, maxlocSci.y, maxlocCmd.x + (scaledWidth * 9 / 8), maxlocCmd.x + (scaledWidth * 5 / 2)), "dip");
-
-	result->eng.SkillValue = OCRNumber(SubMat(bottom, maxlocSci.y, maxlocSci.y + height, maxlocCmd.x - (scaledWidth * 5),
-											  (int)(maxlocCmd.x - (_skill_eng.cols - _skill_sci.cols) * widthScale)),
-									   "eng");
-	result->eng.Primary = HasStar(
-		SubMat(bottom, maxlocSci.y, maxlocSci.y + height, maxlocCmd.x + (scaledWidth * 9 / 8), maxlocCmd.x + (scaledWidth * 5 / 2)), "eng");
-
-	result->sec.SkillValue = OCRNumber(
-		SubMat(bottom, maxlocCmd.y, maxlocCmd.y + height, (int)(maxlocSci.x + scaledWidth * 1.4), maxlocSci.x + (scaledWidth * 6)), "sec");
-	result->sec.Primary = HasStar(
-		SubMat(bottom, maxlocCmd.y, maxlocCmd.y + height, maxlocSci.x - (scaledWidth * 12 / 8), maxlocSci.x - (scaledWidth / 6)), "sec");
-
-	result->med.SkillValue = OCRNumber(
-		SubMat(bottom, maxlocCmd.y + height, maxlocSci.y, (int)(maxlocSci.x + scaledWidth * 1.4), maxlocSci.x + (scaledWidth * 6)), "med");
-	result->med.Primary = HasStar(
-		SubMat(bottom, maxlocCmd.y + height, maxlocSci.y, maxlocSci.x - (scaledWidth * 12 / 8), maxlocSci.x - (scaledWidth / 6)), "med");
-
-	result->sci.SkillValue = OCRNumber(
-		SubMat(bottom, maxlocSci.y, maxlocSci.y + height, (int)(maxlocSci.x + scaledWidth * 1.4), maxlocSci.x + (scaledWidth * 6)), "sci");
-	result->sci.Primary = HasStar(
-		SubMat(bottom, maxlocSci.y, maxlocSci.y + height, maxlocSci.x - (scaledWidth * 12 / 8), maxlocSci.x - (scaledWidth / 6)), "sci");
-
-	return true;
-}
-
-int VoyImageScanner::MatchTop(cv::Mat top)
-{
-	int minHeight = top.rows / 4;
-	int maxHeight = top.rows / 2;
-	int stepHeight = top.rows / 32;
-
-	cv::Point maxloc;
-	int scaledWidth = 0;
-	int height = minHeight;
-	for (; height <= maxHeight; height += stepHeight) {
-		cv::Mat scaled;
-		cv::resize(_antimatter, scaled, cv::Size(_antimatter.cols * height / _antimatter.rows, height), 0, 0, cv::INTER_AREA);
-
-		double maxval = ScaleInvariantTemplateMatch(top, scaled, &maxloc);
-
-		if (maxval > 0.8) {
-			scaledWidth = scaled.cols;
-			break;
-		}
-	}
-
-	if (scaledWidth == 0) {
-		return 0;
-	}
-
-	top = SubMat(top, maxloc.y, maxloc.y + height, maxloc.x + (int)(scaledWidth * 1.05), maxloc.x + (int)(scaledWidth * 6.75));
-	//imwrite("temp.png", top);
-
-	return OCRNumber(top);
-}
-
-VoySearchResults VoyImageScanner::AnalyzeVoyImage(const char *url)
-{
-	size_t fileSize;
-	cv::Mat query;
-	_networkHelper.downloadUrl(url, [&](std::vector<uint8_t> &&v) -> bool {
-		query = cv::imdecode(v, cv::IMREAD_UNCHANGED);
-		fileSize = v.size();
-		return true;
-	});
-
-	return AnalyzeVoyImage(query, fileSize);
-}
-
-VoySearchResults VoyImageScanner::AnalyzeVoyImage(cv::Mat query, size_t fileSize)
-{
-	// Some images are encoded with 2 bytes per channel, scale down for template matching to work
-	if (query.depth() == CV_16U) {
-		// convert to 1-byte
-		query.convertTo(query, CV_8U, 0.00390625);
-	}
-
-	// If the image has an alpha channel, remove it
-	if (query.type() == CV_8UC4) {
-		cv::Mat dst;
-		cv::cvtColor(query, dst, cv::COLOR_BGRA2BGR);
-		query = dst;
-	}
-
-	VoySearchResults result;
-	result.fileSize = fileSize;
-	result.input_height = query.rows;
-	result.input_width = query.cols;
-
-	try {
-		// First, take the top of the image and look for the antimatter
-		cv::Mat top = SubMat(query, 0, std::max(query.rows / 5, 80), query.cols / 3, query.cols * 2 / 3);
-		cv::threshold(top, top, 100, 1, cv::THRESH_TOZERO);
-
-		result.antimatter = MatchTop(top);
-
-		if (result.antimatter == 0) {
-			result.error = "Could not read antimatter";
-			return result;
-		}
-
-		// Sometimes the OCR reads an extra 0 if there's a "particle" in exactly the
-		// wrong spot
-		if (result.antimatter > 8000) {
-			result.antimatter = result.antimatter / 10;
-		}
-
-		double standardScale = (double)query.cols / query.rows;
-		double scaledPercentage = query.rows * (standardScale * 1.2) / 9;
-
-		cv::Mat bottom = SubMat(query, (int)(query.rows - scaledPercentage), query.rows, query.cols / 6, query.cols * 5 / 6);
-
-		cv::threshold(bottom, bottom, 100, 1, cv::THRESH_TOZERO);
-
-		if (!MatchBottom(bottom, &result)) {
-			// Not found
-			result.error = "Could not read skill values";
-			return result;
-		}
-
-		result.valid = true;
-	} catch (std::exception const &e) {
-		result.error = std::string("Exception: ") + e.what();
-		return result;
-	}
-
-	return result;
-}
-
-std::shared_ptr<IVoyImageScanner> MakeVoyImageScanner(const std::string &dataPath)
-{
-	return std::make_shared<VoyImageScanner>(dataPath.c_str());
-}
-
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <vector>
+
+#include <leptonica/allheaders.h>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+
+#include "layoutcache.h"
+#include "templatematcher.h"
+#include "threadpool.h"
+#include "utils.h"
+#include "voyimage.h"
+
+namespace fs = std::filesystem;
+
+namespace DataCore {
+
+// Where the skill icons were found in the bottom strip, at which template height
+struct SkillLayout
+{
+	int height{0};
+	int scaledWidth{0};
+	cv::Mat scaledCmd;
+	cv::Mat scaledSci;
+	cv::Point cmdLoc;
+	cv::Point sciLoc;
+};
+
+// Where the antimatter icon was found in the top strip, at which template height
+struct AntimatterLayout
+{
+	int height{0};
+	int scaledWidth{0};
+	cv::Mat scaled;
+	cv::Point loc;
+};
+
+class VoyImageScanner : public IVoyImageScanner
+{
+  public:
+	VoyImageScanner(const char *dataPath) : _dataPath(dataPath)
+	{
+	}
+
+	~VoyImageScanner();
+
+	bool ReInitialize(bool forceReTraining) override;
+	VoySearchResults AnalyzeVoyImage(const PreparedImage &image, const RequestContext *context) override;
+	int OCRNumber(cv::Mat SkillValue, const std::string &name, const RequestContext *context) override;
+
+  private:
+	int MatchTop(cv::Mat top, cv::Size layoutKey, const RequestContext *context);
+	bool MatchBottom(cv::Mat bottom, cv::Size layoutKey, VoySearchResults *result, const RequestContext *context);
+	bool LocateTop(cv::Mat top, cv::Size layoutKey, AntimatterLayout *layout, const RequestContext *context);
+	bool LocateBottom(cv::Mat bottom, cv::Size layoutKey, SkillLayout *layout, const RequestContext *context);
+	int HasStar(cv::Mat skillImg, const std::string &skillName = "");
+
+	std::shared_ptr<tesseract::TessBaseAPI> _tesseract;
+	std::mutex _tesseractMutex;
+
+	// Analyses share the templates and the OCR engine, ReInitialize replaces them
+	std::shared_mutex _stateMutex;
+
+	cv::Mat _skill_cmd;
+	cv::Mat _skill_dip;
+	cv::Mat _skill_eng;
+	cv::Mat _skill_med;
+	cv::Mat _skill_sci;
+	cv::Mat _skill_sec;
+	cv::Mat _antimatter;
+
+	TemplateMatcher _cmdMatcher;
+	TemplateMatcher _sciMatcher;
+	TemplateMatcher _antimatterMatcher;
+
+	LayoutCache<AntimatterLayout> _topLayouts{"layout.voy_top"};
+	LayoutCache<SkillLayout> _bottomLayouts{"layout.voy_bottom"};
+
+	std::string _dataPath;
+};
+
+VoyImageScanner::~VoyImageScanner()
+{
+	if (_tesseract) {
+		_tesseract->End();
+		_tesseract.reset();
+	}
+}
+
+bool VoyImageScanner::ReInitialize(bool forceReTraining)
+{
+	std::unique_lock<std::shared_mutex> lock(_stateMutex);
+
+	_skill_cmd = cv::imread(fs::path(_dataPath + "cmd.png").make_preferred().string());
+	_skill_dip = cv::imread(fs::path(_dataPath + "dip.png").make_preferred().string());
+	_skill_eng = cv::imread(fs::path(_dataPath + "eng.png").make_preferred().string());
+	_skill_med = cv::imread(fs::path(_dataPath + "med.png").make_preferred().string());
+	_skill_sci = cv::imread(fs::path(_dataPath + "sci.png").make_preferred().string());
+	_skill_sec = cv::imread(fs::path(_dataPath + "sec.png").make_preferred().string());
+	_antimatter = cv::imread(fs::path(_dataPath + "antimatter.png").make_preferred().string());
+
+	// The matchers and cached layouts hold scaled copies of the templates above
+	_cmdMatcher.Reset(_skill_cmd);
+	_sciMatcher.Reset(_skill_sci);
+	_antimatterMatcher.Reset(_antimatter);
+	_topLayouts.Clear();
+	_bottomLayouts.Clear();
+
+	_tesseract = std::make_shared<tesseract::TessBaseAPI>();
+
+	if (_tesseract->Init(fs::path(_dataPath + "tessdata").make_preferred().string().c_str(), "Eurostile")) {
+		// "Could not initialize tesseract"
+		return false;
+	}
+
+	//_tesseract->DefaultPageSegMode = PageSegMode.SingleWord;
+
+	_tesseract->SetVariable("tessedit_char_whitelist", "0123456789");
+	_tesseract->SetVariable("classify_bln_numeric_mode", "1");
+
+	return true;
+}
+
+double ScaleInvariantTemplateMatch(cv::Mat refMat, cv::Mat tplMat, cv::Point *maxloc, double threshold)
+{
+	// refMat must already have the faded stars thresholded out (AnalyzeVoyImage does it once for the top and bottom strips), as
+	// several scales get matched against it concurrently
+	cv::Mat res(refMat.rows - tplMat.rows + 1, refMat.cols - tplMat.cols + 1, CV_32FC1);
+
+	cv::matchTemplate(refMat, tplMat, res, cv::TM_CCORR_NORMED);
+	cv::threshold(res, res, threshold, 1, cv::THRESH_TOZERO);
+
+	double minval, maxval;
+	cv::Point minloc;
+	cv::minMaxLoc(res, &minval, &maxval, &minloc, maxloc);
+
+	return maxval;
+}
+
+// Cheap check that a template is still where a cached layout says it is: only search a small window around the expected spot
+double VerifyTemplateAt(cv::Mat refMat, cv::Mat tplMat, cv::Point expected, cv::Point *maxloc, double threshold = 0.8)
+{
+	int margin = std::max(4, tplMat.rows / 8);
+	cv::Rect window = cv::Rect(expected.x - margin, expected.y - margin, tplMat.cols + margin * 2, tplMat.rows + margin * 2) &
+					  cv::Rect(0, 0, refMat.cols, refMat.rows);
+	if ((window.width < tplMat.cols) || (window.height < tplMat.rows)) {
+		return 0;
+	}
+
+	double maxval = ScaleInvariantTemplateMatch(refMat(window), tplMat, maxloc, threshold);
+	*maxloc += window.tl();
+	return maxval;
+}
+
+struct ScaleMatch
+{
+	cv::Mat scaled;
+	cv::Point loc;
+	double maxval{0};
+};
+
+// Tries every template at every candidate height on the shared pool, and returns the index of the smallest height at which all
+// templates score above threshold (or -1). Heights above an already matching one are skipped, so the answer is the same as
+// walking the heights in order. matches gets heights.size() * templates.size() entries, grouped by height.
+int FindSmallestMatchingScale(cv::Mat refMat, const std::vector<TemplateMatcher *> &templates, const std::vector<int> &heights,
+							  double threshold, std::vector<ScaleMatch> *matches, const RequestContext *context = nullptr)
+{
+	const size_t templateCount = templates.size();
+
+	// The strip's spectrum is computed once and shared by every candidate
+	MatchTarget target(refMat);
+	matches->assign(heights.size() * templateCount, ScaleMatch{});
+
+	std::unique_ptr<std::atomic<size_t>[]> completed(new std::atomic<size_t>[heights.size()]());
+	std::atomic<size_t> firstMatch{heights.size()};
+
+	ThreadPool::Shared().ParallelFor(matches->size(), [&](size_t index) {
+		size_t candidate = index / templateCount;
+		if ((candidate > firstMatch) || IsCancelled(context))
+			return;
+
+		TemplateMatcher *tpl = templates[index % templateCount];
+		int height = heights[candidate];
+
+		ScaleMatch &match = (*matches)[index];
+		match.scaled = tpl->Scaled(height);
+		match.maxval = tpl->MatchMax(target, &match.loc, height);
+
+		if (++completed[candidate] < templateCount)
+			return;
+
+		for (size_t t = 0; t < templateCount; t++) {
+			if ((*matches)[candidate * templateCount + t].maxval <= threshold)
+				return;
+		}
+
+		size_t current = firstMatch;
+		while ((candidate < current) && !firstMatch.compare_exchange_weak(current, candidate)) {
+		}
+	});
+
+	if (IsCancelled(context))
+		return -1;
+
+	return (firstMatch < heights.size()) ? (int)firstMatch : -1;
+}
+
+int VoyImageScanner::OCRNumber(cv::Mat SkillValue, const std::string &name, const RequestContext *context)
+{
+	if (IsCancelled(context))
+		return 0;
+
+	// One engine is shared by all requests
+	std::lock_guard<std::mutex> lock(_tesseractMutex);
+
+	_tesseract->SetImage((uchar *)SkillValue.data, SkillValue.size().width, SkillValue.size().height, SkillValue.channels(),
+						 (int)SkillValue.step1());
+	_tesseract->SetSourceResolution(70);
+	_tesseract->Recognize(0);
+	std::unique_ptr<char[]> out(_tesseract->GetUTF8Text());
+
+	// std::cout << "For " << name << "OCR got " << out.get() << std::endl;
+
+	return out ? std::atoi(out.get()) : 0;
+}
+
+int VoyImageScanner::HasStar(cv::Mat skillImg, const std::string &skillName)
+{
+	cv::Mat center =
+		SubMat(skillImg, (skillImg.rows / 2) - 10, (skillImg.rows / 2) + 10, (skillImg.cols / 2) - 10, (skillImg.cols / 2) + 10);
+
+	auto mean = cv::mean(center);
+
+	if (mean.val[0] + mean.val[1] + mean.val[2] < 10) {
+		return 0;
+	} else if (mean.val[0] < 10) {
+		std::cout << "Primary " << mean.val[0] << " " << mean.val[1] << " " << mean.val[2] << "\n";
+		return 1; // Primary
+	} else if (mean.val[0] + mean.val[1] + mean.val[2] > 100) {
+		std::cout << "Secondary " << mean.val[0] << " " << mean.val[1] << " " << mean.val[2] << "\n";
+		return 2; // Secondary
+	} else {
+		// not sure... hmmm
+		return -1;
+	}
+}
+
+bool VoyImageScanner::LocateBottom(cv::Mat bottom, cv::Size layoutKey, SkillLayout *layout, const RequestContext *context)
+{
+	SkillLayout cached;
+	if (_bottomLayouts.Find(layoutKey, &cached)) {
+		double maxvalCmd = VerifyTemplateAt(bottom, cached.scaledCmd, cached.cmdLoc, &cached.cmdLoc);
+		double maxvalSci = VerifyTemplateAt(bottom, cached.scaledSci, cached.sciLoc, &cached.sciLoc);
+
+		if ((maxvalCmd > 0.9) && (maxvalSci > 0.9)) {
+			_bottomLayouts.RecordHit();
+			*layout = cached;
+			return true;
+		}
+	}
+
+	_bottomLayouts.RecordMiss();
+
+	int minHeight = bottom.rows * 3 / 15;
+	int maxHeight = bottom.rows * 5 / 15;
+	int stepHeight = std::max(bottom.rows / 30, 1);
+
+	std::vector<int> heights;
+	for (int height = minHeight; height <= maxHeight; height += stepHeight) {
+		heights.push_back(height);
+	}
+
+	std::vector<ScaleMatch> matches;
+	int found = FindSmallestMatchingScale(bottom, {&_cmdMatcher, &_sciMatcher}, heights, 0.9, &matches, context);
+	if (found >= 0) {
+		const ScaleMatch &cmd = matches[found * 2];
+		const ScaleMatch &sci = matches[found * 2 + 1];
+
+		layout->height = heights[found];
+		layout->scaledWidth = sci.scaled.cols;
+		layout->scaledCmd = cmd.scaled;
+		layout->scaledSci = sci.scaled;
+		layout->cmdLoc = cmd.loc;
+		layout->sciLoc = sci.loc;
+
+		_bottomLayouts.Store(layoutKey, *layout);
+		return true;
+	}
+
+	// A cancelled search says nothing about the cached layout
+	if (!IsCancelled(context))
+		_bottomLayouts.Evict(layoutKey);
+	return false;
+}
+
+bool VoyImageScanner::MatchBottom(cv::Mat bottom, cv::Size layoutKey, VoySearchResults *result, const RequestContext *context)
+{
+	SkillLayout layout;
+	if (!LocateBottom(bottom, layoutKey, &layout, context)) {
+		return false;
+	}
+
+	int height = layout.height;
+	int scaledWidth = layout.scaledWidth;
+	cv::Point maxlocCmd = layout.cmdLoc;
+	cv::Point maxlocSci = layout.sciLoc;
+
+	double widthScale = (double)scaledWidth / _skill_sci.cols;
+
+	result->cmd.SkillValue = OCRNumber(
+		SubMat(bottom, maxlocCmd.y, maxlocCmd.y + height, maxlocCmd.x - (scaledWidth * 5), maxlocCmd.x - (scaledWidth / 8)), "cmd", context);
+	result->cmd.Primary = HasStar(
+		SubMat(bottom, maxlocCmd.y, maxlocCmd.y + height, maxlocCmd.x + (scaledWidth * 9 / 8), maxlocCmd.x + (scaledWidth * 5 / 2)), "cmd");
+
+	result->dip.SkillValue = OCRNumber(SubMat(bottom, maxlocCmd.y + height, maxlocSci.y, maxlocCmd.x - (scaledWidth * 5),
+											  (int)(maxlocCmd.x - (_skill_dip.cols - _skill_sci.cols) * widthScale)),
+									   "dip", context);
+	result->dip.Primary = HasStar(
+		SubMat(bottom, maxlocCmd.y + height, maxlocSci.y, maxlocCmd.x + (scaledWidth * 9 / 8), maxlocCmd.x + (scaledWidth * 5 / 2)), "dip");
+
+	result->eng.SkillValue = OCRNumber(SubMat(bottom, maxlocSci.y, maxlocSci.y + height, maxlocCmd.x - (scaledWidth * 5),
+											  (int)(maxlocCmd.x - (_skill_eng.cols - _skill_sci.cols) * widthScale)),
+									   "eng", context);
+	result->eng.Primary = HasStar(
+		SubMat(bottom, maxlocSci.y, maxlocSci.y + height, maxlocCmd.x + (scaledWidth * 9 / 8), maxlocCmd.x + (scaledWidth * 5 / 2)), "eng");
+
+	result->sec.SkillValue = OCRNumber(
+		SubMat(bottom, maxlocCmd.y, maxlocCmd.y + height, (int)(maxlocSci.x + scaledWidth * 1.4), maxlocSci.x + (scaledWidth * 6)), "sec", context);
+	result->sec.Primary = HasStar(
+		SubMat(bottom, maxlocCmd.y, maxlocCmd.y + height, maxlocSci.x - (scaledWidth * 12 / 8), maxlocSci.x - (scaledWidth / 6)), "sec");
+
+	result->med.SkillValue = OCRNumber(
+		SubMat(bottom, maxlocCmd.y + height, maxlocSci.y, (int)(maxlocSci.x + scaledWidth * 1.4), maxlocSci.x + (scaledWidth * 6)), "med", context);
+	result->med.Primary = HasStar(
+		SubMat(bottom, maxlocCmd.y + height, maxlocSci.y, maxlocSci.x - (scaledWidth * 12 / 8), maxlocSci.x - (scaledWidth / 6)), "med");
+
+	result->sci.SkillValue = OCRNumber(
+		SubMat(bottom, maxlocSci.y, maxlocSci.y + height, (int)(maxlocSci.x + scaledWidth * 1.4), maxlocSci.x + (scaledWidth * 6)), "sci", context);
+	result->sci.Primary = HasStar(
+		SubMat(bottom, maxlocSci.y, maxlocSci.y + height, maxlocSci.x - (scaledWidth * 12 / 8), maxlocSci.x - (scaledWidth / 6)), "sci");
+
+	return true;
+}
+
+bool VoyImageScanner::LocateTop(cv::Mat top, cv::Size layoutKey, AntimatterLayout *layout, const RequestContext *context)
+{
+	AntimatterLayout cached;
+	if (_topLayouts.Find(layoutKey, &cached)) {
+		if (VerifyTemplateAt(top, cached.scaled, cached.loc, &cached.loc) > 0.8) {
+			_topLayouts.RecordHit();
+			*layout = cached;
+			return true;
+		}
+	}
+
+	_topLayouts.RecordMiss();
+
+	int minHeight = top.rows / 4;
+	int maxHeight = top.rows / 2;
+	int stepHeight = std::max(top.rows / 32, 1);
+
+	std::vector<int> heights;
+	for (int height = minHeight; height <= maxHeight; height += stepHeight) {
+		heights.push_back(height);
+	}
+
+	std::vector<ScaleMatch> matches;
+	int found = FindSmallestMatchingScale(top, {&_antimatterMatcher}, heights, 0.8, &matches, context);
+	if (found >= 0) {
+		layout->height = heights[found];
+		layout->scaledWidth = matches[found].scaled.cols;
+		layout->scaled = matches[found].scaled;
+		layout->loc = matches[found].loc;
+
+		_topLayouts.Store(layoutKey, *layout);
+		return true;
+	}
+
+	// A cancelled search says nothing about the cached layout
+	if (!IsCancelled(context))
+		_topLayouts.Evict(layoutKey);
+	return false;
+}
+
+int VoyImageScanner::MatchTop(cv::Mat top, cv::Size layoutKey, const RequestContext *context)
+{
+	AntimatterLayout layout;
+	if (!LocateTop(top, layoutKey, &layout, context)) {
+		return 0;
+	}
+
+	int height = layout.height;
+	int scaledWidth = layout.scaledWidth;
+	cv::Point maxloc = layout.loc;
+
+	top = SubMat(top, maxloc.y, maxloc.y + height, maxloc.x + (int)(scaledWidth * 1.05), maxloc.x + (int)(scaledWidth * 6.75));
+	//imwrite("temp.png", top);
+
+	return OCRNumber(top, "antimatter", context);
+}
+
+VoySearchResults VoyImageScanner::AnalyzeVoyImage(const PreparedImage &image, const RequestContext *context)
+{
+	std::shared_lock<std::shared_mutex> lock(_stateMutex);
+
+	VoySearchResults result;
+	result.fileSize = image.fileSize;
+	result.input_height = image.inputSize.height;
+	result.input_width = image.inputSize.width;
+
+	if (image.empty()) {
+		result.error = "Could not decode image";
+		return result;
+	}
+
+	// Shared with the other analyzers, so the strips below get thresholded into copies
+	const cv::Mat &query = image.bgr;
+
+	// Layouts are remembered per input resolution, but located in working resolution coordinates
+	cv::Size layoutKey = image.inputSize;
+
+	try {
+		// First, take the top of the image and look for the antimatter (at least 80 pixels of the image as it was sent)
+		cv::Mat top;
+		cv::threshold(SubMat(query, 0, std::max(query.rows / 5, image.FromInput(80)), query.cols / 3, query.cols * 2 / 3), top, 100, 1,
+					  cv::THRESH_TOZERO);
+
+		result.antimatter = MatchTop(top, layoutKey, context);
+
+		if (IsCancelled(context)) {
+			result.error = "Cancelled";
+			return result;
+		}
+
+		if (result.antimatter == 0) {
+			result.error = "Could not read antimatter";
+			return result;
+		}
+
+		// Sometimes the OCR reads an extra 0 if there's a "particle" in exactly the
+		// wrong spot
+		if (result.antimatter > 8000) {
+			result.antimatter = result.antimatter / 10;
+		}
+
+		double standardScale = (double)query.cols / query.rows;
+		double scaledPercentage = query.rows * (standardScale * 1.2) / 9;
+
+		cv::Mat bottom;
+		cv::threshold(SubMat(query, (int)(query.rows - scaledPercentage), query.rows, query.cols / 6, query.cols * 5 / 6), bottom, 100, 1,
+					  cv::THRESH_TOZERO);
+
+		bool matched = MatchBottom(bottom, layoutKey, &result, context);
+		if (IsCancelled(context)) {
+			result.error = "Cancelled";
+			return result;
+		}
+
+		if (!matched) {
+			// Not found
+			result.error = "Could not read skill values";
+			return result;
+		}
+
+		result.valid = true;
+	} catch (std::exception const &e) {
+		result.error = std::string("Exception: ") + e.what();
+		return result;
+	}
+
+	return result;
+}
+
+std::shared_ptr<IVoyImageScanner> MakeVoyImageScanner(const std::string &dataPath)
+{
+	return std::make_shared<VoyImageScanner>(dataPath.c_str());
+}
+
 } // namespace DataCore
\ No newline at end of file
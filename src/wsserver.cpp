@@ -1,84 +1,454 @@
-#include <boost/asio/ip/tcp.hpp>
-#include <boost/beast/core.hpp>
-#include <boost/beast/websocket.hpp>
-#include <cstdlib>
-#include <functional>
-#include <iostream>
-#include <string>
-#include <thread>
-
-#include "wsserver.h"
-
-namespace beast = boost::beast;			// from <boost/beast.hpp>
-namespace http = beast::http;			// from <boost/beast/http.hpp>
-namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
-namespace net = boost::asio;			// from <boost/asio.hpp>
-using tcp = boost::asio::ip::tcp;		// from <boost/asio/ip/tcp.hpp>
-
-namespace DataCore {
-
-void do_session(std::function<std::string(std::string &&)> lambda, tcp::socket &socket)
-{
-	try {
-		// Construct the stream by moving in the socket
-		websocket::stream<tcp::socket> ws{std::move(socket)};
-
-		// Set a decorator to change the Server of the handshake
-		ws.set_option(
-			websocket::stream_base::decorator([](websocket::response_type &res) { res.set(http::field::server, "DataCore-CV"); }));
-
-		// Accept the websocket handshake
-		ws.accept();
-
-		for (;;) {
-			// This buffer will hold the incoming message
-			beast::flat_buffer buffer;
-
-			// Read a message
-			ws.read(buffer);
-
-			ws.text(ws.got_text());
-
-			std::string message = beast::buffers_to_string(buffer.data());
-			std::string reply = lambda(std::move(message));
-
-			ws.write(net::buffer(reply));
-		}
-	} catch (beast::system_error const &se) {
-		// This indicates that the session was closed
-		if (se.code() != websocket::error::closed)
-			std::cerr << "Error: " << se.code().message() << std::endl;
-	} catch (std::exception const &e) {
-		std::cerr << "Error: " << e.what() << std::endl;
-	}
-}
-
-bool start_websocket_server(std::function<std::string(std::string &&)> lambda, const char *addr, unsigned short port) noexcept
-{
-	try {
-		auto const address = net::ip::make_address(addr);
-
-		// The io_context is required for all I/O
-		net::io_context ioc{1};
-
-		// The acceptor receives incoming connections
-		tcp::acceptor acceptor{ioc, {address, port}};
-		for (;;) {
-			// This will receive the new connection
-			tcp::socket socket{ioc};
-
-			// Block until we get a connection
-			acceptor.accept(socket);
-
-			// Launch the session, transferring ownership of the socket
-			std::thread{std::bind(&do_session, lambda, std::move(socket))}.detach();
-		}
-
-		return true;
-	} catch (const std::exception &e) {
-		std::cerr << "Error: " << e.what() << std::endl;
-		return false;
-	}
-}
-
-} // namespace DataCore
\ No newline at end of file
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "admission.h"
+#include "analyzeservice.h"
+#include "metrics.h"
+#include "networkhelper.h"
+#include "threadpool.h"
+#include "wsserver.h"
+
+namespace beast = boost::beast;			// from <boost/beast.hpp>
+namespace http = beast::http;			// from <boost/beast/http.hpp>
+namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
+namespace net = boost::asio;			// from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp;		// from <boost/asio/ip/tcp.hpp>
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+using local = boost::asio::local::stream_protocol;
+#endif
+
+namespace DataCore {
+
+// State shared by the listener and every session
+struct websocket_server
+{
+	AnalyzeHandler lambda;
+	WebSocketServerOptions options;
+	std::atomic<size_t> connections{0};
+};
+
+// One client connection, over TCP or a Unix domain socket
+template <class Protocol> class websocket_session : public std::enable_shared_from_this<websocket_session<Protocol>>
+{
+  public:
+	websocket_session(typename Protocol::socket &&socket, std::shared_ptr<websocket_server> server) : ws_(std::move(socket)), server_(server)
+	{
+		server_->connections++;
+	}
+
+	~websocket_session()
+	{
+		server_->connections--;
+	}
+
+	void start()
+	{
+		// All handlers of a session run on its strand
+		net::dispatch(ws_.get_executor(), [self = this->shared_from_this()] { self->read_upgrade(); });
+	}
+
+  private:
+	struct outgoing_reply
+	{
+		bool text{true};
+		std::string payload;
+	};
+
+	// Plain string protocol requests carry no id, so their replies keep the order the requests came in. Each one gets a
+	// slot here that is handed to the write queue once every earlier one has been.
+	struct ordered_reply
+	{
+		bool done{false};
+		outgoing_reply reply;
+	};
+
+	websocket::stream<beast::basic_stream<Protocol>> ws_;
+	std::shared_ptr<websocket_server> server_;
+
+	beast::flat_buffer buffer_;
+	http::request<http::string_body> upgrade_;
+	ResponseEncoding encoding_{ResponseEncoding::Json};
+
+	// From the upgrade request's X-Priority header, envelopes can override it per request
+	TaskPriority priority_{TaskPriority::Interactive};
+
+	std::deque<ordered_reply> ordered_;
+	uint64_t firstSequence_{0};
+
+	// Replies ready to go out, enveloped ones in completion order
+	std::deque<outgoing_reply> outgoing_;
+
+	// Requests read whose reply hasn't been written yet
+	size_t outstanding_{0};
+
+	bool reading_{false};
+	bool writing_{false};
+	bool closed_{false};
+
+	// A message read while maxOutstanding requests are in flight waits in buffer_ until one of them has been answered
+	bool held_{false};
+	bool watching_{false};
+
+	// Cancelled once the connection closes; parent of every request's context, so queued requests are dropped unstarted and
+	// running ones stop at the next stage
+	std::shared_ptr<RequestContext> context_{std::make_shared<RequestContext>()};
+
+	// Read the upgrade request ourselves to see which encoding the client offers as subprotocol
+	void read_upgrade()
+	{
+		beast::get_lowest_layer(ws_).expires_after(std::chrono::seconds(30));
+
+		http::async_read(beast::get_lowest_layer(ws_), buffer_, upgrade_,
+						 [self = this->shared_from_this()](beast::error_code ec, std::size_t) { self->on_upgrade(ec); });
+	}
+
+	void on_upgrade(beast::error_code ec)
+	{
+		if (ec || !websocket::is_upgrade(upgrade_))
+			return;
+
+		beast::get_lowest_layer(ws_).expires_never();
+		ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+		ws_.read_message_max(server_->options.maxMessageSize);
+
+		auto offered = upgrade_[http::field::sec_websocket_protocol];
+		std::string_view protocol;
+		encoding_ = EncodingFromSubprotocol(std::string_view(offered.data(), offered.size()), &protocol);
+
+		auto priority = upgrade_["X-Priority"];
+		ParsePriority(std::string_view(priority.data(), priority.size()), &priority_);
+
+		// Set a decorator to change the Server of the handshake
+		ws_.set_option(websocket::stream_base::decorator([protocol = std::string(protocol)](websocket::response_type &res) {
+			res.set(http::field::server, "DataCore-CV");
+			if (!protocol.empty())
+				res.set(http::field::sec_websocket_protocol, protocol);
+		}));
+
+		// Accept the websocket handshake
+		ws_.async_accept(upgrade_, [self = this->shared_from_this()](beast::error_code ec) {
+			if (!ec)
+				self->read_message();
+		});
+	}
+
+	// A read stays posted at maxOutstanding too, so a close or a dropped connection cancels the requests in flight; only the one
+	// message it returns is kept back then
+	void read_message()
+	{
+		if (reading_ || held_ || closed_)
+			return;
+
+		reading_ = true;
+		buffer_.consume(buffer_.size());
+		ws_.async_read(buffer_, [self = this->shared_from_this()](beast::error_code ec, std::size_t) { self->on_read(ec); });
+	}
+
+	void on_read(beast::error_code ec)
+	{
+		reading_ = false;
+
+		if (ec) {
+			// This indicates that the session was closed
+			if (ec != websocket::error::closed)
+				std::cerr << "Error: " << ec.message() << std::endl;
+			closed_ = true;
+			context_->Cancel();
+			return;
+		}
+
+		if (outstanding_ >= server_->options.maxOutstanding) {
+			held_ = true;
+			watch_disconnect();
+			return;
+		}
+
+		handle_message();
+		read_message();
+	}
+
+	// While a message is held nothing reads the socket, so it only becomes readable with more data behind that message or when
+	// the client hung up. Only the latter can be told without reading.
+	void watch_disconnect()
+	{
+		if (watching_)
+			return;
+
+		watching_ = true;
+		auto &socket = beast::get_lowest_layer(ws_).socket();
+		socket.async_wait(net::socket_base::wait_read, [self = this->shared_from_this(), &socket](beast::error_code ec) {
+			self->watching_ = false;
+			if (ec || !self->held_)
+				return;
+
+			char peek;
+			std::size_t read = socket.receive(net::buffer(&peek, 1), net::socket_base::message_peek, ec);
+			if (ec || (read == 0)) {
+				self->closed_ = true;
+				self->context_->Cancel();
+			}
+		});
+	}
+
+	// Queues the message in buffer_ on the worker pool, or answers it right away when admission turns it down
+	void handle_message()
+	{
+		// Binary encodings go out as binary frames, JSON in whatever frame type the request came in
+		bool text = (encoding_ == ResponseEncoding::Json) && ws_.got_text();
+
+		// The analysis runs on the worker pool. Image frames take the whole buffer along and decode the image from it in place,
+		// reads continue into a fresh one; commands are small and get copied out.
+		std::function<void(const AnalyzeHandler &, std::string &)> handle;
+		bool ordered = false;
+
+		// Operation and priority are all that's needed to cost and queue the request; anything unparseable fails for free
+		auto data = buffer_.data();
+		AnalyzeRequest estimate;
+		estimate.priority = priority_;
+		if (!PeekRequest(static_cast<const uint8_t *>(data.data()), data.size(), &estimate))
+			estimate.operation = AnalyzeOperation::Metrics;
+
+		if (!ws_.got_text() && IsImageFrame(static_cast<const uint8_t *>(data.data()), data.size())) {
+			auto frame = std::make_shared<beast::flat_buffer>(std::move(buffer_));
+			buffer_ = beast::flat_buffer();
+
+			handle = [frame, encoding = encoding_](const AnalyzeHandler &handler, std::string &out) {
+				auto data = frame->data();
+				HandleImageFrame(handler, static_cast<const uint8_t *>(data.data()), data.size(), out, encoding);
+			};
+		} else {
+			std::string message(static_cast<const char *>(data.data()), data.size());
+			ordered = !IsEnvelope(message);
+
+			handle = [message = std::move(message), encoding = encoding_](const AnalyzeHandler &handler, std::string &out) {
+				HandleCommand(handler, message, out, encoding);
+			};
+		}
+
+		uint64_t sequence = firstSequence_ + ordered_.size();
+		if (ordered)
+			ordered_.emplace_back();
+		outstanding_++;
+
+		std::shared_ptr<AdmissionController::Ticket> ticket;
+		if (server_->options.admission) {
+			int retryAfter = 1;
+			ticket = server_->options.admission->TryAdmit(AdmissionController::EstimateCost(estimate), &retryAfter, estimate.priority);
+			if (!ticket) {
+				// Answer right away instead of queueing; the envelope still gets parsed so the reply carries its id
+				outgoing_reply reply;
+				reply.text = text;
+				handle(
+					[retryAfter](const AnalyzeRequest &request) {
+						AnalyzeResponse busy;
+						busy.operation = request.operation;
+						busy.error = "Server busy, retry in " + std::to_string(retryAfter) + "s";
+						return busy;
+					},
+					reply.payload);
+
+				on_reply(ordered, sequence, std::move(reply));
+				return;
+			}
+		}
+
+		auto context =
+			std::make_shared<RequestContext>(RequestContext::Clock::now() + server_->options.requestTimeout, context_);
+
+		ThreadPool::Shared().Post(
+			[self = this->shared_from_this(), ordered, sequence, text, handle = std::move(handle), ticket, context] {
+				if (self->context_->Cancelled()) {
+					// The connection is gone, don't start on it
+					Metrics::Instance().Increment("admission.expired");
+					return;
+				}
+
+				if (ticket)
+					ticket->Start();
+
+				outgoing_reply reply;
+				reply.text = text;
+				try {
+					handle(
+						[&lambda = self->server_->lambda, &context](const AnalyzeRequest &request) {
+							// Timed out while queued; the client still gets a reply so its ordered slot doesn't block the rest
+							if (context->Cancelled()) {
+								Metrics::Instance().Increment("admission.expired");
+								AnalyzeResponse cancelled;
+								cancelled.operation = request.operation;
+								cancelled.error = "Cancelled";
+								return cancelled;
+							}
+
+							// Failing here keeps the reply wrapped with the request's id
+							try {
+								AnalyzeRequest withContext = request;
+								withContext.context = context;
+								return lambda(withContext);
+							} catch (const std::exception &e) {
+								std::cerr << "Error: " << e.what() << std::endl;
+								return AnalyzeResponse{};
+							}
+						},
+						reply.payload);
+				} catch (const std::exception &e) {
+					// Only encoding the reply is left to fail here
+					std::cerr << "Error: " << e.what() << std::endl;
+					reply.payload.clear();
+					if (ordered)
+						EncodeResponse(reply.payload, AnalyzeResponse{}, self->encoding_);
+					else
+						EncodeEnvelope(reply.payload, nullptr, AnalyzeResponse{}, self->encoding_);
+				}
+
+				net::post(self->ws_.get_executor(), [self, ordered, sequence, reply = std::move(reply)]() mutable {
+					self->on_reply(ordered, sequence, std::move(reply));
+				});
+			},
+			estimate.priority);
+	}
+
+	void on_reply(bool ordered, uint64_t sequence, outgoing_reply &&reply)
+	{
+		if (!ordered) {
+			outgoing_.push_back(std::move(reply));
+		} else {
+			ordered_reply &slot = ordered_[sequence - firstSequence_];
+			slot.done = true;
+			slot.reply = std::move(reply);
+
+			while (!ordered_.empty() && ordered_.front().done) {
+				outgoing_.push_back(std::move(ordered_.front().reply));
+				ordered_.pop_front();
+				firstSequence_++;
+			}
+		}
+
+		write_reply();
+	}
+
+	void write_reply()
+	{
+		if (writing_ || closed_ || outgoing_.empty())
+			return;
+
+		writing_ = true;
+		ws_.text(outgoing_.front().text);
+		ws_.async_write(net::buffer(outgoing_.front().payload), [self = this->shared_from_this()](beast::error_code ec, std::size_t) {
+			self->writing_ = false;
+			if (ec) {
+				self->closed_ = true;
+				self->context_->Cancel();
+				return;
+			}
+
+			self->outgoing_.pop_front();
+			self->outstanding_--;
+
+			if (self->held_) {
+				self->held_ = false;
+				self->handle_message();
+			}
+
+			self->write_reply();
+			self->read_message();
+		});
+	}
+};
+
+// Accepts connections on its own strand and hands each one to a new session
+template <class Protocol> class websocket_listener : public std::enable_shared_from_this<websocket_listener<Protocol>>
+{
+  public:
+	websocket_listener(net::io_context &ioc, typename Protocol::endpoint endpoint, std::shared_ptr<websocket_server> server)
+		: ioc_(ioc), acceptor_(net::make_strand(ioc), endpoint), server_(server)
+	{
+	}
+
+	void start()
+	{
+		acceptor_.async_accept(net::make_strand(ioc_), [self = this->shared_from_this()](beast::error_code ec,
+																						 typename Protocol::socket socket) {
+			if (!ec) {
+				if (self->server_->connections >= self->server_->options.maxConnections) {
+					std::cerr << "Too many websocket connections, closing a new one" << std::endl;
+					socket.close(ec);
+				} else {
+					std::make_shared<websocket_session<Protocol>>(std::move(socket), self->server_)->start();
+				}
+			}
+			self->start();
+		});
+	}
+
+  private:
+	net::io_context &ioc_;
+	typename Protocol::acceptor acceptor_;
+	std::shared_ptr<websocket_server> server_;
+};
+
+bool start_websocket_server(AnalyzeHandler lambda, const char *addr, unsigned short port, const WebSocketServerOptions &options) noexcept
+{
+	try {
+		auto const address = net::ip::make_address(addr);
+		size_t threadCount = std::max<size_t>(options.ioThreads, 1);
+
+		auto server = std::make_shared<websocket_server>();
+		server->lambda = lambda;
+		server->options = options;
+		server->options.maxOutstanding = std::max<size_t>(options.maxOutstanding, 1);
+
+		// The io_context is required for all I/O
+		net::io_context ioc{(int)threadCount};
+
+		bool listening = false;
+		if (port != 0) {
+			std::make_shared<websocket_listener<tcp>>(ioc, tcp::endpoint{address, port}, server)->start();
+			listening = true;
+		}
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		if (!options.unixPath.empty()) {
+			std::make_shared<websocket_listener<local>>(ioc, UnixSocketEndpoint(options.unixPath), server)->start();
+			listening = true;
+		}
+#else
+		if (!options.unixPath.empty())
+			std::cerr << "Unix domain sockets are not supported here, not listening on " << options.unixPath << std::endl;
+#endif
+
+		if (!listening)
+			return false;
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < threadCount; i++) {
+			threads.emplace_back([&ioc] { ioc.run(); });
+		}
+		ioc.run();
+
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		return true;
+	} catch (const std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return false;
+	}
+}
+
+} // namespace DataCore
@@ -1,8 +1,41 @@
-#include <string>
-
-namespace DataCore {
-
-bool start_websocket_server(std::function<std::string(std::string &&)> lambda, const char *addr = "0.0.0.0",
-							unsigned short port = 5000) noexcept;
-
-}
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "admission.h"
+#include "analyzerequest.h"
+
+namespace DataCore {
+
+struct WebSocketServerOptions
+{
+	// Threads running the socket I/O; the analysis itself runs on the shared ThreadPool
+	size_t ioThreads{2};
+
+	// Connections above this are closed right after accept
+	size_t maxConnections{256};
+
+	// A connection stops reading new messages while this many of its requests are still being worked on
+	size_t maxOutstanding{4};
+
+	// Largest message accepted, binary frames carry whole screenshots
+	size_t maxMessageSize{32 * 1024 * 1024};
+
+	// Requests still queued or running this long after they were read are cancelled
+	std::chrono::seconds requestTimeout{60};
+
+	// Requests over budget are answered with an error right away; unset admits everything
+	std::shared_ptr<AdmissionController> admission;
+
+	// Also listen on this Unix domain socket path (a stale socket file there is replaced); empty for none
+	std::string unixPath;
+};
+
+// Speaks the string protocol, plain or in id-carrying envelopes, and takes inline screenshots in binary frames; see
+// ParseCommand, IsEnvelope and IsImageFrame
+// A port of 0 skips the TCP listener, serving only options.unixPath
+bool start_websocket_server(AnalyzeHandler lambda, const char *addr = "0.0.0.0", unsigned short port = 5000,
+							const WebSocketServerOptions &options = WebSocketServerOptions()) noexcept;
+
+}
@@ -0,0 +1,157 @@
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "jsonwriter.h"
+#include "testing.h"
+
+using namespace DataCore;
+
+// WriteJson promises exactly what the nlohmann serialization gives, so every case compares the two byte for byte
+
+template <typename T> static void CheckSame(const T &value)
+{
+	std::string written;
+	WriteJson(written, value);
+	CHECK_EQUAL(written, nlohmann::json(value).dump());
+}
+
+// Strings the analyzers can hand back: urls from chat, OCR and exception text
+static const char *STRINGS[] = {"",
+								"plain",
+								"say \"cheese\"",
+								"back\\slash",
+								"C:\\Users\\me\\Pictures\\\"voyage\".png",
+								"tab\tnew line\ncarriage return\rbackspace\bform feed\f",
+								"\x01\x02\x1f\x7f",
+								"Kirk \xc3\xa9t\xc3\xa9, \xe2\x80\x9cquoted\xe2\x80\x9d \xf0\x9f\x96\x96 \"mixed\"\n",
+								"\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e",
+								"https://cdn.discordapp.com/attachments/1/2/image%20(1).png?width=1440&height=720&path=a/b%2Fc",
+								"</script><script>alert(1)</script>"};
+
+static SearchResults BeholdResults(const std::string &text, int number)
+{
+	SearchResults results{};
+	results.input_width = number;
+	results.input_height = -number;
+	results.fileSize = (size_t)number;
+	results.closebuttons = number;
+	results.error = text;
+	results.top = {text, number, 0};
+	results.crew1 = {"ent_crew_sto_mirror_picard", std::numeric_limits<int>::max(), 5};
+	results.crew2 = {text + text, std::numeric_limits<int>::min(), 255};
+	results.crew3 = {"", 0, 1};
+	return results;
+}
+
+static VoySearchResults VoyageResults(const std::string &text, int number)
+{
+	VoySearchResults results{};
+	results.input_width = number;
+	results.input_height = -number;
+	results.fileSize = (size_t)number;
+	results.error = text;
+	results.valid = (number % 2) == 0;
+	results.antimatter = number;
+	results.cmd = {number, 1};
+	results.dip = {-number, 2};
+	results.eng = {std::numeric_limits<int>::max(), 3};
+	results.med = {std::numeric_limits<int>::min(), 0};
+	results.sci = {0, -1};
+	results.sec = {1125, 0};
+	return results;
+}
+
+static const int NUMBERS[] = {0, 1, -1, 7, 2840, 1080, std::numeric_limits<int>::max(), std::numeric_limits<int>::min()};
+
+static void TestSearchResults()
+{
+	for (const char *text : STRINGS) {
+		for (int number : NUMBERS)
+			CheckSame(BeholdResults(text, number));
+	}
+
+	// The largest file sizes still print as unsigned
+	SearchResults results = BeholdResults("big", 1);
+	results.fileSize = std::numeric_limits<size_t>::max();
+	CheckSame(results);
+}
+
+static void TestVoySearchResults()
+{
+	for (const char *text : STRINGS) {
+		for (int number : NUMBERS)
+			CheckSame(VoyageResults(text, number));
+	}
+
+	VoySearchResults results = VoyageResults("big", 1);
+	results.fileSize = std::numeric_limits<size_t>::max();
+	CheckSame(results);
+}
+
+static void TestAnalyzeResponse()
+{
+	const AnalyzeOperation OPERATIONS[] = {AnalyzeOperation::Behold,  AnalyzeOperation::VoyImage, AnalyzeOperation::Both,
+										   AnalyzeOperation::Metrics, AnalyzeOperation::ReInit,	  AnalyzeOperation::ForceReInit};
+	const ScreenType TYPES[] = {ScreenType::Unknown, ScreenType::Behold, ScreenType::Voyage};
+	const int64_t DURATIONS[] = {0, 182, -1, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()};
+
+	for (AnalyzeOperation operation : OPERATIONS) {
+		for (const char *text : STRINGS) {
+			AnalyzeResponse response;
+			response.operation = operation;
+			response.url = text;
+			response.beholdResult = BeholdResults(text, 2340);
+			response.voyResult = VoyageResults(text, 1080);
+			response.metrics = {{"requests", 12}, {"latency", {{"p50", 1.5}, {"p99", 182.25}}}, {"note", text}};
+
+			for (ScreenType type : TYPES) {
+				for (int64_t duration : DURATIONS) {
+					response.success = true;
+					response.screenType = type;
+					response.durationMs = duration;
+					CheckSame(response);
+				}
+			}
+
+			// Failures carry only the error, when there is one
+			response.success = false;
+			response.error = text;
+			CheckSame(response);
+		}
+	}
+}
+
+static void TestInvalidUtf8()
+{
+	// Both refuse to write a string that isn't UTF-8
+	SearchResults results = BeholdResults("truncated \xe2\x80", 1);
+
+	bool nlohmannThrew = false;
+	try {
+		nlohmann::json(results).dump();
+	} catch (const nlohmann::json::type_error &) {
+		nlohmannThrew = true;
+	}
+
+	bool writerThrew = false;
+	try {
+		std::string written;
+		WriteJson(written, results);
+	} catch (const nlohmann::json::type_error &) {
+		writerThrew = true;
+	}
+
+	CHECK(nlohmannThrew);
+	CHECK(writerThrew);
+}
+
+int main()
+{
+	TestSearchResults();
+	TestVoySearchResults();
+	TestAnalyzeResponse();
+	TestInvalidUtf8();
+
+	return DataCore::Testing::TestResult();
+}
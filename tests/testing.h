@@ -0,0 +1,50 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Just enough of a test harness for the unit tests: CHECK and CHECK_EQUAL report the failing expression and carry on, the test's
+// main returns TestResult() as its exit code for ctest.
+
+namespace DataCore {
+namespace Testing {
+
+inline int &Failures()
+{
+	static int failures = 0;
+	return failures;
+}
+
+inline void Fail(const char *file, int line, const std::string &message)
+{
+	std::cerr << file << ":" << line << ": " << message << std::endl;
+	Failures()++;
+}
+
+inline int TestResult()
+{
+	if (Failures() > 0)
+		std::cerr << Failures() << " check(s) failed" << std::endl;
+	return (Failures() == 0) ? 0 : 1;
+}
+
+} // namespace Testing
+} // namespace DataCore
+
+#define CHECK(expression)                                                                                                          \
+	do {                                                                                                                           \
+		if (!(expression))                                                                                                         \
+			DataCore::Testing::Fail(__FILE__, __LINE__, "CHECK(" #expression ") failed");                                          \
+	} while (false)
+
+#define CHECK_EQUAL(actual, expected)                                                                                              \
+	do {                                                                                                                           \
+		const auto &actualValue = (actual);                                                                                        \
+		const auto &expectedValue = (expected);                                                                                    \
+		if (!(actualValue == expectedValue)) {                                                                                     \
+			std::ostringstream message;                                                                                            \
+			message << #actual << " is \"" << actualValue << "\", expected \"" << expectedValue << "\"";                           \
+			DataCore::Testing::Fail(__FILE__, __LINE__, message.str());                                                            \
+		}                                                                                                                          \
+	} while (false)